@@ -0,0 +1,101 @@
+#include <algorithm>
+#include "arbiter.hpp"
+#include "qos_arbiter.hpp"
+
+uint32_t Arbiter::messageBytes(const Message& msg) {
+    bool returns_data = msg.type == MessageType::READ_MEM || msg.type == MessageType::READ_SHARED ||
+                        msg.type == MessageType::READ_EXCLUSIVE;
+    size_t words = msg.data.size() + (returns_data ? msg.size : 0);
+    return MESSAGE_HEADER_BYTES + static_cast<uint32_t>(words * 4);
+}
+
+void FlowQueues::push(Message&& msg) {
+    uint16_t flow = msg.src;
+    if (flow >= flows.size()) {
+        flows.resize(static_cast<size_t>(flow) + 1);
+    }
+    if (flows[flow].empty()) {
+        active.push_back(flow);
+    }
+    flows[flow].push_back(std::move(msg));
+    count++;
+}
+
+Message FlowQueues::popFront(uint16_t flow) {
+    Message msg = std::move(flows[flow].front());
+    flows[flow].pop_front();
+    if (flows[flow].empty()) {
+        active.pop_front();
+    }
+    count--;
+    return msg;
+}
+
+void FlowQueues::rotate() {
+    active.push_back(active.front());
+    active.pop_front();
+}
+
+Message RoundRobinArbiter::pop(uint64_t) {
+    uint16_t flow = queues.frontFlow();
+    Message msg = queues.popFront(flow);
+    if (!queues.flowEmpty(flow)) {
+        queues.rotate();
+    }
+    return msg;
+}
+
+void DeficitRoundRobinArbiter::push(Message&& msg) {
+    if (msg.src >= deficit.size()) {
+        deficit.resize(static_cast<size_t>(msg.src) + 1, 0);
+    }
+    queues.push(std::move(msg));
+}
+
+Message DeficitRoundRobinArbiter::pop(uint64_t) {
+    // Every pass adds a quantum to the front PE, so the loop ends
+    while (true) {
+        uint16_t flow = queues.frontFlow();
+        uint32_t bytes = messageBytes(queues.head(flow));
+        if (deficit[flow] >= bytes) {
+            deficit[flow] -= bytes;
+            Message msg = queues.popFront(flow);
+            if (queues.flowEmpty(flow)) {
+                deficit[flow] = 0;
+            }
+            return msg;
+        }
+        deficit[flow] += DRR_QUANTUM_BYTES;
+        queues.rotate();
+    }
+}
+
+void WeightedFairArbiter::push(Message&& msg) {
+    if (msg.src >= last_finish.size()) {
+        last_finish.resize(static_cast<size_t>(msg.src) + 1, 0);
+    }
+
+    // Scaled by the number of QoS levels so that bytes / weight stays exact enough in integers
+    uint64_t weight = static_cast<uint64_t>(msg.qos) + 1;
+    uint64_t start = std::max(virtual_time, last_finish[msg.src]);
+    uint64_t finish = start + messageBytes(msg) * NUM_QOS_LEVELS / weight;
+    last_finish[msg.src] = finish;
+    queue.push(Tagged{std::move(msg), finish, next_seq++});
+}
+
+Message WeightedFairArbiter::pop(uint64_t) {
+    Tagged tagged = queue.popTop();
+    virtual_time = tagged.finish;
+    return std::move(tagged.msg);
+}
+
+std::unique_ptr<Arbiter> makeArbiter(ArbitrationScheme scheme) {
+    switch (scheme) {
+        case ArbitrationScheme::QOS: return std::make_unique<QoSArbiter>();
+        case ArbitrationScheme::ROUND_ROBIN: return std::make_unique<RoundRobinArbiter>();
+        case ArbitrationScheme::WFQ: return std::make_unique<WeightedFairArbiter>();
+        case ArbitrationScheme::DRR: return std::make_unique<DeficitRoundRobinArbiter>();
+        case ArbitrationScheme::FIFO: break;
+    }
+    return nullptr;
+}
@@ -0,0 +1,171 @@
+#ifndef ARBITER_HPP
+#define ARBITER_HPP
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "constants.hpp"
+#include "message.hpp"
+#include "movable_priority_queue.hpp"
+#include "system_config.hpp"
+
+/**
+ * @brief Ingress queue that decides which pending message the interconnect services next.
+ *
+ * Arbiters are not thread-safe; each interconnect worker guards its own.
+ */
+class Arbiter {
+public:
+    virtual ~Arbiter() = default;
+
+    /**
+     * @brief Queues a message.
+     */
+    virtual void push(Message&& msg) = 0;
+
+    /**
+     * @brief Removes the next message to service.
+     *
+     * The arbiter must not be empty.
+     *
+     * @param now Current cycle of the interconnect.
+     * @return The removed message.
+     */
+    virtual Message pop(uint64_t now) = 0;
+
+    virtual size_t size() const = 0;
+
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Gets the bytes a message moves through the interconnect.
+     *
+     * Counts the header and the data words of the request, plus the words
+     * a read returns, so that a READ_MEM of a whole block weighs as much as
+     * the WRITE_MEM of that block.
+     */
+    static uint32_t messageBytes(const Message& msg);
+};
+
+/**
+ * @brief One FIFO queue per source PE, shared by the per-PE arbiters.
+ *
+ * Flows with queued messages sit in an active list in the order they
+ * became active, so finding the next flow never scans idle PEs.
+ */
+class FlowQueues {
+private:
+    std::vector<std::deque<Message>> flows;     // Queued messages of each PE
+    std::deque<uint16_t> active;                // PEs with queued messages
+    size_t count = 0;                           // Queued messages
+
+public:
+    /**
+     * @brief Queues a message at the back of the flow of its source PE.
+     */
+    void push(Message&& msg);
+
+    /**
+     * @brief Gets the flow at the front of the active list.
+     */
+    uint16_t frontFlow() const { return active.front(); }
+
+    const Message& head(uint16_t flow) const { return flows[flow].front(); }
+
+    /**
+     * @brief Removes the head of a flow; the flow leaves the active list when it empties.
+     *
+     * @param flow Flow at the front of the active list.
+     * @return The removed message.
+     */
+    Message popFront(uint16_t flow);
+
+    /**
+     * @brief Moves the front flow to the back of the active list.
+     */
+    void rotate();
+
+    bool flowEmpty(uint16_t flow) const { return flows[flow].empty(); }
+
+    size_t size() const { return count; }
+};
+
+/**
+ * @brief Round-robin between PEs: one message per PE with queued messages per turn.
+ */
+class RoundRobinArbiter : public Arbiter {
+private:
+    FlowQueues queues;
+
+public:
+    void push(Message&& msg) override { queues.push(std::move(msg)); }
+    Message pop(uint64_t now) override;
+    size_t size() const override { return queues.size(); }
+};
+
+/**
+ * @brief Deficit round-robin between PEs, sized by message bytes.
+ *
+ * Each turn a PE earns DRR_QUANTUM_BYTES of credit and sends messages
+ * while its credit covers their size, so PEs moving large blocks do not
+ * take more bandwidth than PEs sending small requests. An emptied PE loses
+ * its leftover credit.
+ */
+class DeficitRoundRobinArbiter : public Arbiter {
+private:
+    FlowQueues queues;
+    std::vector<uint32_t> deficit;              // Unused credit of each PE (bytes)
+
+public:
+    void push(Message&& msg) override;
+    Message pop(uint64_t now) override;
+    size_t size() const override { return queues.size(); }
+};
+
+/**
+ * @brief Self-clocked weighted fair queuing between PEs.
+ *
+ * A PE's weight is its QoS value plus one (qos_config.txt), so a PE with
+ * QoS 0x3F gets 64 times the bandwidth share of a PE with QoS 0x00 when
+ * both are backlogged. Each message is stamped on arrival with a virtual
+ * finish time, max(system virtual time, finish time of the previous
+ * message of its PE) + bytes / weight, and the smallest stamp is serviced
+ * first. The system virtual time is the stamp of the last serviced message.
+ */
+class WeightedFairArbiter : public Arbiter {
+private:
+    struct Tagged {
+        Message msg;
+        uint64_t finish;                        // Virtual finish time
+        uint64_t seq;                           // Arrival order, breaks ties
+    };
+
+    struct TagComparator {
+        bool operator()(const Tagged& a, const Tagged& b) const {
+            if (a.finish != b.finish) return a.finish > b.finish;
+            return a.seq > b.seq;
+        }
+    };
+
+    MovablePriorityQueue<Tagged, TagComparator> queue;
+    std::vector<uint64_t> last_finish;          // Finish time of the newest message of each PE
+    uint64_t virtual_time = 0;
+    uint64_t next_seq = 0;
+
+public:
+    void push(Message&& msg) override;
+    Message pop(uint64_t now) override;
+    size_t size() const override { return queue.size(); }
+};
+
+/**
+ * @brief Creates the arbiter of a scheme.
+ *
+ * @param scheme Arbitration scheme.
+ * @return The arbiter, or nullptr for FIFO (serviced from the lock-free ring).
+ */
+std::unique_ptr<Arbiter> makeArbiter(ArbitrationScheme scheme);
+
+#endif // ARBITER_HPP
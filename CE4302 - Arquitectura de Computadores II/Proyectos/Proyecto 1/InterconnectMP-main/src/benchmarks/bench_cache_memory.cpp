@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../cache_memory.hpp"
+#include "../payload.hpp"
+
+/**
+ * Benchmark of PE cache traffic: the previous CacheMemory layout (a vector of
+ * blocks, each with its own std::vector of words and a bool) against the flat
+ * word array with a valid bitmap. The operations follow the PE paths:
+ *  - sendMessage: WRITE_MEM copies consecutive blocks into the payload
+ *  - processResponse: READ_RESP copies the payload into consecutive blocks
+ *  - invalidate: BROADCAST_INVALIDATE of random blocks
+ *  - scan: invalidate every block, refill and count the valid blocks
+ *
+ * Usage: ./benchmarks/bench_cache_memory [operations]
+ */
+
+/**
+ * @brief Baseline cache, equivalent to the original CacheMemory storage.
+ */
+class LegacyCache {
+private:
+    struct Block {
+        std::vector<uint32_t> data;
+        bool valid;
+    };
+    std::vector<Block> blocks;
+
+public:
+    LegacyCache(uint32_t num_blocks, uint32_t words_per_block)
+        : blocks(num_blocks, Block{std::vector<uint32_t>(words_per_block, 0), true}) {}
+
+    const std::vector<uint32_t>& readBlock(uint32_t index) const {
+        if (index >= blocks.size()) throw std::out_of_range("Block index out of range");
+        if (!blocks[index].valid) throw std::runtime_error("Attempt to read an invalid block");
+        return blocks[index].data;
+    }
+
+    void writeWord(uint32_t index, uint32_t offset, uint32_t value) {
+        if (index >= blocks.size()) throw std::out_of_range("Block index out of range");
+        blocks[index].data[offset] = value;
+        blocks[index].valid = true;
+    }
+
+    void invalidateBlock(uint32_t index) { blocks.at(index).valid = false; }
+
+    void invalidateAll() {
+        for (auto& block : blocks) block.valid = false;
+    }
+
+    void fill(uint32_t value) {
+        for (auto& block : blocks) {
+            std::fill(block.data.begin(), block.data.end(), value);
+            block.valid = true;
+        }
+    }
+
+    uint32_t countValid() const {
+        uint32_t valid = 0;
+        for (const auto& block : blocks) valid += block.valid;
+        return valid;
+    }
+};
+
+/**
+ * @brief Times an operation and returns the operations per second.
+ */
+template <typename Operation>
+double opsPerSecond(size_t operations, Operation operation) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; i++) {
+        operation(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return operations / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    size_t operations = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const uint32_t num_blocks = NUMBER_OF_CACHE_BLOCKS;
+    const uint32_t words_per_block = WORDS_PER_BLOCK;
+    const uint32_t blocks_per_message = 4;
+
+    LegacyCache legacy(num_blocks, words_per_block);
+    CacheMemory flat(num_blocks, words_per_block);
+    PayloadArena arena;
+    uint64_t checksum = 0;
+
+    std::vector<uint32_t> response(blocks_per_message * words_per_block, 0x5A5A5A5A);
+    std::mt19937 rng(7);
+    std::vector<uint32_t> victims(operations);
+    for (auto& victim : victims) victim = rng() % num_blocks;
+
+    auto first_block = [&](size_t i) {
+        return static_cast<uint32_t>(i % (num_blocks - blocks_per_message + 1));
+    };
+
+    struct Row {
+        const char* name;
+        double legacy_rate;
+        double flat_rate;
+    };
+    std::vector<Row> rows;
+
+    rows.push_back({"sendMessage (WRITE_MEM)",
+        opsPerSecond(operations, [&](size_t i) {
+            Payload data;
+            data.setArena(&arena);
+            uint32_t block = first_block(i);
+            for (uint32_t b = 0; b < blocks_per_message; b++) {
+                const std::vector<uint32_t>& words = legacy.readBlock(block + b);
+                std::vector<uint32_t> copy = words; // The original code copied each block first
+                data.append(copy);
+            }
+            checksum += data.back();
+        }),
+        opsPerSecond(operations, [&](size_t i) {
+            Payload data;
+            data.setArena(&arena);
+            uint32_t block = first_block(i);
+            for (uint32_t b = 0; b < blocks_per_message; b++) {
+                data.append(flat.readBlock(block + b));
+            }
+            checksum += data.back();
+        })});
+
+    rows.push_back({"processResponse (READ_RESP)",
+        opsPerSecond(operations, [&](size_t i) {
+            uint32_t block = first_block(i);
+            uint32_t offset = 0;
+            for (uint32_t word : response) {
+                if (offset == words_per_block) {
+                    offset = 0;
+                    block++;
+                }
+                legacy.writeWord(block, offset++, word);
+            }
+        }),
+        opsPerSecond(operations, [&](size_t i) {
+            std::span<const uint32_t> words = response;
+            for (uint32_t block = first_block(i); !words.empty(); block++) {
+                size_t chunk = std::min<size_t>(words.size(), words_per_block);
+                std::copy_n(words.begin(), chunk, flat.writableBlock(block).begin());
+                words = words.subspan(chunk);
+            }
+        })});
+
+    rows.push_back({"invalidate block",
+        opsPerSecond(operations, [&](size_t i) { legacy.invalidateBlock(victims[i]); }),
+        opsPerSecond(operations, [&](size_t i) { flat.invalidateBlock(victims[i]); })});
+
+    rows.push_back({"invalidate all + fill + scan",
+        opsPerSecond(operations / 10, [&](size_t) {
+            legacy.invalidateAll();
+            legacy.fill(2);
+            checksum += legacy.countValid();
+        }),
+        opsPerSecond(operations / 10, [&](size_t) {
+            flat.invalidateAll();
+            flat.fill(2);
+            checksum += flat.countValid();
+        })});
+
+    std::cout << "PE cache traffic (" << num_blocks << " blocks x " << words_per_block << " words, "
+              << blocks_per_message << " blocks per message)\n\n"
+              << std::left << std::setw(32) << "operation"
+              << std::right << std::setw(16) << "legacy (op/s)"
+              << std::setw(16) << "flat (op/s)"
+              << std::setw(10) << "speedup" << "\n";
+
+    for (const Row& row : rows) {
+        std::cout << std::fixed << std::setprecision(0)
+                  << std::left << std::setw(32) << row.name
+                  << std::right << std::setw(16) << row.legacy_rate
+                  << std::setw(16) << row.flat_rate
+                  << std::setprecision(2) << std::setw(9) << row.flat_rate / row.legacy_rate << "x\n";
+    }
+
+    std::cout << "\n(checksum " << checksum << ")\n";
+    return 0;
+}
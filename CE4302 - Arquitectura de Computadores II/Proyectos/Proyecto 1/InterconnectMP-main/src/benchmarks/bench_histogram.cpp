@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../histogram.hpp"
+
+/**
+ * Benchmark of the stats latency samples: the previous std::vector of every
+ * sample, sorted to answer percentiles, against the log-linear Histogram.
+ * Samples follow a log-normal distribution similar to the request latencies
+ * of a loaded interconnect (a few hundred cycles with a long tail). Reports
+ * record and query time, memory, and the relative error of each percentile.
+ *
+ * Usage: ./benchmarks/bench_histogram [samples]
+ */
+
+/**
+ * @brief Gets a nearest-rank percentile of sorted samples.
+ */
+uint64_t exactPercentile(const std::vector<uint64_t>& sorted, double fraction) {
+    size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+int main(int argc, char* argv[]) {
+    size_t samples = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    const double fractions[] = {0.50, 0.90, 0.99, 0.999, 1.0};
+
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> latency(6.0, 1.0);
+    std::vector<uint64_t> values(samples);
+    for (auto& value : values) {
+        value = static_cast<uint64_t>(latency(rng));
+    }
+
+    // Baseline: keep every sample, sort a copy for the percentiles
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> kept;
+    for (uint64_t value : values) {
+        kept.push_back(value);
+    }
+    double vector_record = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> sorted = kept;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<uint64_t> exact;
+    for (double fraction : fractions) {
+        exact.push_back(exactPercentile(sorted, fraction));
+    }
+    double vector_query = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    Histogram histogram;
+    for (uint64_t value : values) {
+        histogram.record(value);
+    }
+    double histogram_record = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> approx;
+    for (double fraction : fractions) {
+        approx.push_back(histogram.percentile(fraction));
+    }
+    double histogram_query = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Latency samples (" << samples << " log-normal values)\n\n"
+              << std::fixed << std::setprecision(2)
+              << std::left << std::setw(12) << "storage"
+              << std::right << std::setw(14) << "record ns" << std::setw(14) << "query ms"
+              << std::setw(14) << "memory KiB" << "\n"
+              << std::left << std::setw(12) << "vector"
+              << std::right << std::setw(14) << 1e9 * vector_record / samples
+              << std::setw(14) << 1e3 * vector_query
+              << std::setw(14) << kept.capacity() * sizeof(uint64_t) / 1024.0 << "\n"
+              << std::left << std::setw(12) << "histogram"
+              << std::right << std::setw(14) << 1e9 * histogram_record / samples
+              << std::setw(14) << 1e3 * histogram_query
+              << std::setw(14) << histogram.buckets() * sizeof(uint64_t) / 1024.0 << "\n\n"
+              << std::left << std::setw(12) << "percentile"
+              << std::right << std::setw(14) << "exact" << std::setw(14) << "histogram"
+              << std::setw(14) << "error" << "\n";
+    const char* names[] = {"p50", "p90", "p99", "p99.9", "max"};
+    for (size_t i = 0; i < exact.size(); i++) {
+        double error = exact[i] > 0 ? 100.0 * (static_cast<double>(approx[i]) - exact[i]) / exact[i] : 0.0;
+        std::cout << std::left << std::setw(12) << names[i]
+                  << std::right << std::setw(14) << exact[i] << std::setw(14) << approx[i]
+                  << std::setw(13) << error << "%\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include "../instruction_memory.hpp"
+
+/**
+ * Benchmark of workload loading: the previous text loader (std::map lookup,
+ * uppercase copy and istringstream/substr/stoul per line, Messages stored in
+ * a std::queue), the current text parser, and a compiled binary trace mapped
+ * with mmap. Each variant loads a generated workload and then drains it
+ * through the instruction interface like a PE does.
+ *
+ * Usage: ./benchmarks/bench_instruction_load [instructions]
+ */
+
+/**
+ * @brief Previous text loader, kept as the baseline.
+ */
+size_t loadPrevious(const std::string& filename, std::queue<Message>& instructions) {
+    std::ifstream file(filename);
+    std::map<std::string, MessageType> instructionMap = {
+        {"WRITE_MEM", MessageType::WRITE_MEM},
+        {"READ_MEM", MessageType::READ_MEM},
+        {"BROADCAST_INVALIDATE", MessageType::BROADCAST_INVALIDATE}
+    };
+
+    auto operand = [](std::string s) {
+        s = (s.size() >= 2 && s.find("0X") == 0) ? s.substr(2) : s;
+        s = (s.size() > 0 && s.back() == ',') ? s.substr(0, s.size() - 1) : s;
+        return static_cast<uint32_t>(std::stoul(s, nullptr, 16));
+    };
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t commentPos = line.find("//");
+        if (commentPos != std::string::npos) {
+            line = line.substr(0, commentPos);
+        }
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t") + 1);
+        if (line.empty()) {
+            continue;
+        }
+        std::string upperLine = line;
+        std::transform(upperLine.begin(), upperLine.end(), upperLine.begin(),
+                       [](unsigned char c){ return std::toupper(c); });
+
+        std::istringstream iss(upperLine);
+        std::string instructionType, a, b, c;
+        iss >> instructionType;
+        Message msg{};
+        msg.type = instructionMap[instructionType];
+        msg.src = INTERCONNECT_ID;
+        msg.dest = INTERCONNECT_ID;
+        try {
+            switch (msg.type) {
+                case MessageType::WRITE_MEM:
+                    iss >> a >> b >> c;
+                    msg.addr = operand(a);
+                    msg.start_cache_line = operand(b);
+                    msg.num_of_cache_lines = operand(c);
+                    break;
+                case MessageType::BROADCAST_INVALIDATE:
+                    iss >> a;
+                    msg.cache_line = operand(a);
+                    break;
+                case MessageType::READ_MEM:
+                    iss >> a >> b;
+                    msg.addr = operand(a);
+                    msg.size = operand(b);
+                    break;
+                default:
+                    continue;
+            }
+            instructions.push(std::move(msg));
+        } catch (...) {
+            continue;
+        }
+    }
+    return instructions.size();
+}
+
+double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::string text_file = "/tmp/bench_instruction_load.txt";
+    const std::string binary_file = "/tmp/bench_instruction_load.bin";
+
+    // Workload with the same mix and syntax as the shipped inst_pe_N.txt files
+    {
+        std::mt19937 rng(42);
+        std::ofstream out(text_file);
+        out << std::hex << std::uppercase << std::setfill('0');
+        for (size_t i = 0; i < count; i++) {
+            switch (rng() % 3) {
+                case 0: out << "READ_MEM 0x" << std::setw(4) << (rng() % 0x4000) * 4 << ", 0x" << std::setw(4) << 1 + rng() % 0x40 << "\n"; break;
+                case 1: out << "WRITE_MEM 0x" << std::setw(4) << (rng() % 0x4000) * 4 << ", 0x" << std::setw(2) << rng() % 0x40 << ", 0x" << std::setw(2) << 1 + rng() % 0x8 << "\n"; break;
+                default: out << "BROADCAST_INVALIDATE 0x" << std::setw(2) << rng() % 0x80 << "\n"; break;
+            }
+        }
+    }
+    {
+        InstructionMemory compiler;
+        compiler.loadFromFile(text_file);
+        compiler.saveBinary(binary_file);
+    }
+
+    uint64_t checksum = 0;
+    std::cout << "Workload loading (" << count << " instructions)\n\n"
+              << std::fixed << std::setprecision(1)
+              << std::left << std::setw(16) << "loader"
+              << std::right << std::setw(12) << "load ms" << std::setw(12) << "drain ms"
+              << std::setw(14) << "memory MiB" << "\n";
+    auto row = [](const char* name, double load, double drain, double bytes) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(12) << 1e3 * load
+                  << std::setw(12) << 1e3 * drain << std::setw(14) << bytes / (1 << 20) << "\n";
+    };
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::queue<Message> instructions;
+        size_t loaded = loadPrevious(text_file, instructions);
+        double load = seconds(start);
+        start = std::chrono::steady_clock::now();
+        while (!instructions.empty()) {
+            Message msg = std::move(instructions.front());
+            instructions.pop();
+            checksum += msg.addr;
+        }
+        row("previous text", load, seconds(start), static_cast<double>(loaded) * sizeof(Message));
+    }
+
+    for (const std::string& file : {text_file, binary_file}) {
+        auto start = std::chrono::steady_clock::now();
+        InstructionMemory memory;
+        memory.loadFromFile(file);
+        double load = seconds(start);
+        size_t loaded = memory.remaining();
+        start = std::chrono::steady_clock::now();
+        while (memory.hasInstructions()) {
+            checksum += memory.nextInstruction().addr;
+        }
+        row(file == text_file ? "text" : "binary (mmap)", load, seconds(start),
+            static_cast<double>(loaded) * sizeof(InstructionRecord));
+    }
+
+    std::cout << "\nThe binary trace memory is page cache, shared by every PE mapping the same file"
+              << " (checksum " << checksum << ")\n";
+    std::remove(text_file.c_str());
+    std::remove(binary_file.c_str());
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../interconnect.hpp"
+#include "../processing_element.hpp"
+
+/**
+ * Benchmark of the address-sharded interconnect. 16 PEs run the shipped
+ * workloads (inst_pe_0..15, each repeated) on the thread engine while the
+ * interconnect is split into 1 to 8 workers over 8 memory banks, and the
+ * requests answered per second of wall time are reported. PE console output
+ * is discarded; the interconnect and PE logs are still written.
+ *
+ * Run from src/ so the workload and log paths resolve.
+ *
+ * Usage: ./benchmarks/bench_interconnect_workers [repeats]
+ */
+
+const uint16_t BENCH_PES = 16;
+
+struct RoundResult {
+    double rate;                // Requests per second
+    size_t requests;            // Requests answered (a split request counts once)
+    double busiest_share;       // Percentage of the messages serviced by the busiest worker
+};
+
+/**
+ * @brief Runs every workload once with the given number of interconnect workers.
+ */
+RoundResult runRound(uint32_t workers, size_t repeats) {
+    SystemConfig config;
+    config.num_pes = BENCH_PES;
+    config.interconnect_workers = workers;
+
+    SharedMemory memory(config.shared_memory_size, config.memory_banks);
+    Interconnect interconnect(memory, ArbitrationScheme::FIFO, std::max<size_t>(INTERCONNECT_QUEUE_CAPACITY, BENCH_PES));
+    interconnect.setWorkers(workers, config.words_per_block * INTERCONNECT_SHARD_BLOCKS);
+
+    ProcessingElement::resetIDs();
+    std::vector<std::unique_ptr<ProcessingElement>> pes;
+    for (uint16_t i = 0; i < BENCH_PES; i++) {
+        auto pe = std::make_unique<ProcessingElement>(0, config);
+        std::string workload = "../resources/pe_instructions/inst_pe_" + std::to_string(i) + ".txt";
+        for (size_t r = 0; r < repeats; r++) {
+            pe->loadInstructions(workload);
+        }
+        pe->setCache(i);
+        interconnect.registerPE(pe.get());
+        pes.push_back(std::move(pe));
+    }
+
+    // The PEs also change the stream formatting (hex, fill), so restore it afterwards
+    std::ios format(nullptr);
+    format.copyfmt(std::cout);
+    std::streambuf* out = std::cout.rdbuf(nullptr);
+    std::streambuf* err = std::cerr.rdbuf(nullptr);
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread interconnect_thread([&interconnect]() { interconnect.processMessages(); });
+    std::vector<std::thread> pe_threads;
+    for (auto& pe : pes) {
+        pe_threads.emplace_back([&interconnect, pe_ptr = pe.get()]() { pe_ptr->process(interconnect); });
+    }
+    for (auto& thread : pe_threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    interconnect.stopProcessing();
+    interconnect_thread.join();
+    std::cout.rdbuf(out);
+    std::cerr.rdbuf(err);
+    std::cout.copyfmt(format);
+    std::cout.clear();
+    std::cerr.clear();
+
+    const InterconnectStats& stats = interconnect.getStats();
+    size_t busiest = 0;
+    for (size_t messages : stats.worker_messages) {
+        busiest = std::max(busiest, messages);
+    }
+    // Pieces of split requests are serviced separately but answered once
+    size_t total = stats.total_messages_processed;
+    size_t requests = total - stats.split_pieces + stats.split_requests;
+    return {requests / seconds, requests, total > 0 ? 100.0 * busiest / total : 0.0};
+}
+
+int main(int argc, char* argv[]) {
+    size_t repeats = argc > 1 ? std::stoul(argv[1]) : 200;
+    const uint32_t worker_counts[] = {1, 2, 4, 8};
+
+    std::cout << "Interconnect throughput (" << BENCH_PES << " PEs, workloads repeated " << repeats
+              << " times, " << DEFAULT_MEMORY_BANKS << " banks, "
+              << std::thread::hardware_concurrency() << " hardware threads)\n\n"
+              << std::left << std::setw(9) << "workers"
+              << std::right << std::setw(12) << "requests"
+              << std::setw(16) << "requests/s"
+              << std::setw(12) << "speedup"
+              << std::setw(16) << "busiest worker" << "\n";
+
+    double baseline = 0.0;
+    for (uint32_t workers : worker_counts) {
+        RoundResult result = runRound(workers, repeats);
+        if (baseline == 0.0) {
+            baseline = result.rate;
+        }
+        std::cout << std::fixed << std::left << std::setw(9) << workers
+                  << std::right << std::setw(12) << result.requests
+                  << std::setprecision(0) << std::setw(16) << result.rate
+                  << std::setprecision(2) << std::setw(11) << result.rate / baseline << "x"
+                  << std::setw(15) << result.busiest_share << "%\n";
+    }
+
+    return 0;
+}
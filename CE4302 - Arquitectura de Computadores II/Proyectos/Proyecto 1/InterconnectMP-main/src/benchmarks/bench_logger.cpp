@@ -0,0 +1,91 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../logger.hpp"
+
+/**
+ * Benchmark of the Logger backends: many producer threads log short records
+ * (like the PE and interconnect threads of the simulator) to a temporary
+ * file, through the synchronous path (one mutex, timestamp formatting and a
+ * flushed write per record) and through the asynchronous per-thread rings
+ * with both overflow policies. Reports the records per second seen by the
+ * producers, the time to drain what was still buffered, and the drops.
+ *
+ * Usage: ./benchmarks/bench_logger [threads] [records per thread]
+ */
+
+struct Result {
+    double produce_seconds;     // Until every producer returned
+    double total_seconds;       // Until every record was written
+    uint64_t dropped;
+};
+
+Result run(size_t threads, size_t records, bool async, LogOverflow policy, const std::string& path) {
+    Logger logger(path, false);
+    if (async) {
+        logger.startAsync(policy);
+    }
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < threads; t++) {
+        producers.emplace_back([&, t]() {
+            std::string source = "PE " + std::to_string(t);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < records; i++) {
+                logger.log("READ_MEM addr=0x" + std::to_string(i & 0xFFF) + " size=4", source);
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    auto produced = std::chrono::steady_clock::now();
+    uint64_t dropped = logger.stopAsync();
+    auto written = std::chrono::steady_clock::now();
+
+    return {std::chrono::duration<double>(produced - start).count(),
+            std::chrono::duration<double>(written - start).count(), dropped};
+}
+
+int main(int argc, char* argv[]) {
+    size_t threads = argc > 1 ? std::stoul(argv[1]) : 16;
+    size_t records = argc > 2 ? std::stoul(argv[2]) : 20000;
+    const std::string path = "/tmp/bench_logger.txt";
+
+    struct Mode { const char* name; bool async; LogOverflow policy; };
+    const Mode modes[] = {
+        {"sync", false, LogOverflow::DROP},
+        {"async-drop", true, LogOverflow::DROP},
+        {"async-block", true, LogOverflow::BLOCK},
+    };
+
+    size_t total = threads * records;
+    std::cout << "Logger (" << threads << " producer threads, " << records << " records each, "
+              << LOGGER_RING_CAPACITY << " records per ring)\n\n"
+              << std::fixed << std::setprecision(2)
+              << std::left << std::setw(14) << "mode"
+              << std::right << std::setw(16) << "produce Mrec/s" << std::setw(16) << "written Mrec/s"
+              << std::setw(12) << "dropped" << "\n";
+    for (const Mode& mode : modes) {
+        Result result = run(threads, records, mode.async, mode.policy, path);
+        double kept = static_cast<double>(total - result.dropped);
+        std::cout << std::left << std::setw(14) << mode.name
+                  << std::right << std::setw(16) << total / result.produce_seconds / 1e6
+                  << std::setw(16) << kept / result.total_seconds / 1e6
+                  << std::setw(12) << result.dropped << "\n";
+    }
+    std::remove(path.c_str());
+
+    return 0;
+}
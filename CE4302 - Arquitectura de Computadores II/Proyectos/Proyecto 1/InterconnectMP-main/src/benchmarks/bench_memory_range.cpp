@@ -0,0 +1,95 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../shared_memory.hpp"
+
+/**
+ * Benchmark of the interconnect READ_MEM/WRITE_MEM memory path: the previous
+ * per-word readByPosition/writeByPosition loop (one bounds check and one lock
+ * per word, payload grown with push_back) against readRange/writeRange (one
+ * check and one lock per transfer into a pre-sized payload).
+ *
+ * Usage: ./benchmarks/bench_memory_range [transfers_per_size]
+ */
+
+/**
+ * @brief Times a transfer function and returns the words moved per second.
+ */
+template <typename Transfer>
+double wordsPerSecond(size_t transfers, uint32_t words, Transfer transfer) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < transfers; i++) {
+        transfer(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(transfers) * words / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    size_t transfers = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const uint32_t transfer_sizes[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512};
+
+    SharedMemory memory;
+    memory.fillRandom(42);
+    uint32_t size = memory.getSize();
+    uint64_t checksum = 0;
+
+    std::cout << "Shared memory transfer throughput (" << transfers << " transfers per size, "
+              << memory.getNumBanks() << " banks)\n\n"
+              << std::left << std::setw(8) << "words"
+              << std::right << std::setw(16) << "read loop"
+              << std::setw(16) << "readRange"
+              << std::setw(10) << "speedup"
+              << std::setw(16) << "write loop"
+              << std::setw(16) << "writeRange"
+              << std::setw(10) << "speedup" << "\n";
+
+    for (uint32_t words : transfer_sizes) {
+        // Walk the memory so consecutive transfers start on different banks
+        auto start_of = [size, words](size_t i) {
+            return static_cast<uint32_t>((i * 7) % (size - words + 1));
+        };
+
+        double read_loop = wordsPerSecond(transfers, words, [&](size_t i) {
+            std::vector<uint32_t> data;
+            uint32_t pos = start_of(i);
+            for (uint32_t w = 0; w < words; w++) {
+                data.push_back(memory.readByPosition(pos++));
+            }
+            checksum += data.back();
+        });
+
+        double read_range = wordsPerSecond(transfers, words, [&](size_t i) {
+            std::vector<uint32_t> data(words);
+            memory.readRange(start_of(i), data);
+            checksum += data.back();
+        });
+
+        std::vector<uint32_t> payload(words, 0xA5A5A5A5);
+
+        double write_loop = wordsPerSecond(transfers, words, [&](size_t i) {
+            uint32_t pos = start_of(i);
+            for (uint32_t value : payload) {
+                memory.writeByPosition(pos++, value);
+            }
+        });
+
+        double write_range = wordsPerSecond(transfers, words, [&](size_t i) {
+            memory.writeRange(start_of(i), payload);
+        });
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << std::left << std::setw(8) << words
+                  << std::right << std::setw(16) << read_loop
+                  << std::setw(16) << read_range
+                  << std::setprecision(2) << std::setw(9) << read_range / read_loop << "x"
+                  << std::setprecision(0) << std::setw(16) << write_loop
+                  << std::setw(16) << write_range
+                  << std::setprecision(2) << std::setw(9) << write_range / write_loop << "x\n";
+    }
+
+    std::cout << "\n(words/s; checksum " << checksum << ")\n";
+    return 0;
+}
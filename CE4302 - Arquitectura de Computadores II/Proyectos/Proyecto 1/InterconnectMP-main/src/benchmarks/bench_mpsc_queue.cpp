@@ -0,0 +1,107 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../message.hpp"
+#include "../mpsc_ring_buffer.hpp"
+
+/**
+ * Benchmark of the interconnect ingress path: the previous std::queue<Message>
+ * guarded by a mutex against the lock-free MPSCRingBuffer. Each producer plays
+ * the role of a PE and the single consumer plays the role of the interconnect.
+ *
+ * Usage: ./benchmarks/bench_mpsc_queue [messages_per_producer]
+ */
+
+/**
+ * @brief Baseline ingress queue, equivalent to the original Interconnect code.
+ */
+class MutexQueue {
+private:
+    std::queue<Message> queue;
+    std::mutex queue_mutex;
+
+public:
+    void push(const Message& msg) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.push(msg);
+    }
+
+    bool tryPop(Message& out) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (queue.empty()) return false;
+        out = queue.front();
+        queue.pop();
+        return true;
+    }
+};
+
+/**
+ * @brief Runs one producer/consumer round and returns the messages per second.
+ */
+template <typename Queue>
+double runRound(Queue& queue, int producers, size_t per_producer) {
+    Message base{MessageType::WRITE_MEM, 0x00, INTERCONNECT_ID, 0x0000, 0x0000, 0x00, 0x00, 0x01, 0x00, 0x0, {1, 2, 3, 4}};
+    size_t total = per_producer * producers;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, &base, p, per_producer]() {
+            Message msg = base;
+            msg.src = static_cast<uint16_t>(p);
+            for (size_t i = 0; i < per_producer; i++) {
+                queue.push(msg);
+            }
+        });
+    }
+
+    Message out;
+    size_t consumed = 0;
+    while (consumed < total) {
+        if (queue.tryPop(out)) {
+            consumed++;
+        } else {
+            std::this_thread::yield(); // Let producers run on machines with few cores
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    size_t per_producer = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const int producer_counts[] = {2, 4, 8, 16, 32, 64};
+
+    std::cout << "Interconnect ingress throughput (" << per_producer << " messages per producer)\n\n"
+              << std::left << std::setw(8) << "PEs"
+              << std::right << std::setw(18) << "mutex (msg/s)"
+              << std::setw(18) << "ring (msg/s)"
+              << std::setw(10) << "speedup" << "\n";
+
+    for (int producers : producer_counts) {
+        MutexQueue mutex_queue;
+        MPSCRingBuffer<Message> ring(INTERCONNECT_QUEUE_CAPACITY);
+
+        double mutex_rate = runRound(mutex_queue, producers, per_producer);
+        double ring_rate = runRound(ring, producers, per_producer);
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << std::left << std::setw(8) << producers
+                  << std::right << std::setw(18) << mutex_rate
+                  << std::setw(18) << ring_rate
+                  << std::setprecision(2) << std::setw(9) << ring_rate / mutex_rate << "x\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../shared_memory.hpp"
+
+/**
+ * Benchmark of concurrent shared memory access. Every thread plays the role
+ * of the interconnect servicing one PE and performs a read-modify-write per
+ * position, either at random positions or walking a fixed stride. A single
+ * bank reproduces the original global lock.
+ *
+ * Usage: ./benchmarks/bench_shared_memory [accesses_per_thread]
+ */
+
+enum class Pattern { RANDOM, STRIDED };
+
+struct RoundResult {
+    double rate;            // Accesses per second
+    double conflict_rate;   // Percentage of accesses that found their bank busy
+};
+
+/**
+ * @brief Runs one access round and returns its throughput and conflict rate.
+ */
+RoundResult runRound(uint32_t banks, int threads, size_t per_thread, Pattern pattern) {
+    SharedMemory memory(SHARED_MEMORY_SIZE, banks);
+    uint32_t size = memory.getSize();
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&memory, size, t, per_thread, pattern]() {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<uint32_t> dist(0, size - 1);
+            uint32_t pos = t;
+            for (size_t i = 0; i < per_thread; i++) {
+                if (pattern == Pattern::RANDOM) {
+                    pos = dist(rng);
+                } else {
+                    pos = (pos + WORDS_PER_BLOCK) % size;
+                }
+                memory.writeByPosition(pos, memory.readByPosition(pos) + 1);
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double accesses = static_cast<double>(memory.getBankAccesses());
+    return {accesses / seconds, accesses > 0 ? 100.0 * memory.getBankConflicts() / accesses : 0.0};
+}
+
+int main(int argc, char* argv[]) {
+    size_t per_thread = argc > 1 ? std::stoul(argv[1]) : 500000;
+    const uint32_t bank_counts[] = {1, 8, 32};
+    const int thread_counts[] = {1, 2, 4, 8};
+    const std::pair<Pattern, const char*> patterns[] = {
+        {Pattern::RANDOM, "random"}, {Pattern::STRIDED, "strided"}};
+
+    std::cout << "Shared memory throughput (" << per_thread << " read-modify-writes per thread, "
+              << std::thread::hardware_concurrency() << " hardware threads)\n\n"
+              << std::left << std::setw(10) << "pattern"
+              << std::setw(8) << "banks"
+              << std::setw(9) << "threads"
+              << std::right << std::setw(18) << "accesses/s"
+              << std::setw(14) << "conflicts" << "\n";
+
+    for (const auto& [pattern, name] : patterns) {
+        for (uint32_t banks : bank_counts) {
+            for (int threads : thread_counts) {
+                RoundResult result = runRound(banks, threads, per_thread, pattern);
+                std::cout << std::fixed << std::left << std::setw(10) << name
+                          << std::setw(8) << banks
+                          << std::setw(9) << threads
+                          << std::right << std::setprecision(0) << std::setw(18) << result.rate
+                          << std::setprecision(2) << std::setw(13) << result.conflict_rate << "%\n";
+            }
+        }
+    }
+
+    return 0;
+}
@@ -1,88 +1,123 @@
+#include <algorithm>
+#include <bit>
 #include <random>
 #include <stdexcept>
 #include "cache_memory.hpp"
 
-void CacheMemory::writeBlock(uint8_t block_index, const std::vector<uint32_t>& words) {
-    if (block_index >= NUMBER_OF_CACHE_BLOCKS) {
+CacheMemory::CacheMemory(uint32_t blocks, uint32_t block_words)
+    : num_blocks(blocks), words_per_block(block_words),
+      words(static_cast<uint32_t*>(::operator new[](std::max<size_t>(totalWords(), 1) * sizeof(uint32_t),
+                                                    std::align_val_t(CACHE_LINE_SIZE)))),
+      valid_bits((static_cast<size_t>(blocks) + 63) / 64) {
+    fill(0);
+}
+
+void CacheMemory::checkBlock(uint32_t block_index) const {
+    if (block_index >= num_blocks) {
         throw std::out_of_range("Block index out of range");
     }
-    if (words.size() != WORDS_PER_BLOCK) {
-        throw std::invalid_argument("Exactly 4 words are required per block");
+}
+
+void CacheMemory::writeBlock(uint32_t block_index, std::span<const uint32_t> values) {
+    checkBlock(block_index);
+    if (values.size() != words_per_block) {
+        throw std::invalid_argument("Exactly " + std::to_string(words_per_block) + " words are required per block");
     }
     
-    memory[block_index].data = words;
-    memory[block_index].valid = true;
+    std::copy(values.begin(), values.end(), blockPtr(block_index));
+    setValid(block_index);
 }
 
-void CacheMemory::writeWord(uint8_t block_index, uint8_t word_offset, uint32_t value) {
-    if (block_index >= NUMBER_OF_CACHE_BLOCKS) {
-        throw std::out_of_range("Block index out of range");
-    }
-    if (word_offset >= WORDS_PER_BLOCK) {
+void CacheMemory::writeWord(uint32_t block_index, uint32_t word_offset, uint32_t value) {
+    checkBlock(block_index);
+    if (word_offset >= words_per_block) {
         throw std::out_of_range("Word offset out of range");
     }
     
-    memory[block_index].data[word_offset] = value;
-    memory[block_index].valid = true;
+    blockPtr(block_index)[word_offset] = value;
+    setValid(block_index);
 }
 
-const std::vector<uint32_t>& CacheMemory::readBlock(uint8_t block_index) const {
-    if (block_index >= NUMBER_OF_CACHE_BLOCKS) {
-        throw std::out_of_range("Block index out of range");
-    }
-    if (!memory[block_index].valid) {
+std::span<const uint32_t> CacheMemory::readBlock(uint32_t block_index) const {
+    checkBlock(block_index);
+    if (!testValid(block_index)) {
         throw std::runtime_error("Attempt to read an invalid block");
     }
     
-    return memory[block_index].data;
+    return {blockPtr(block_index), words_per_block};
 }
 
-uint32_t CacheMemory::readWord(uint8_t block_index, uint8_t word_offset) const {
-    if (block_index >= NUMBER_OF_CACHE_BLOCKS) {
-        throw std::out_of_range("Block index out of range");
-    }
-    if (word_offset >= WORDS_PER_BLOCK) {
+std::span<uint32_t> CacheMemory::writableBlock(uint32_t block_index) {
+    checkBlock(block_index);
+    setValid(block_index);
+    return {blockPtr(block_index), words_per_block};
+}
+
+uint32_t CacheMemory::readWord(uint32_t block_index, uint32_t word_offset) const {
+    checkBlock(block_index);
+    if (word_offset >= words_per_block) {
         throw std::out_of_range("Word offset out of range");
     }
-    if (!memory[block_index].valid) {
+    if (!testValid(block_index)) {
         throw std::runtime_error("Attempt to read an invalid block");
     }
     
-    return memory[block_index].data[word_offset];
+    return blockPtr(block_index)[word_offset];
 }
 
-void CacheMemory::invalidateBlock(uint8_t block_index) {
-    if (block_index >= NUMBER_OF_CACHE_BLOCKS) {
-        throw std::out_of_range("Block index out of range");
+void CacheMemory::invalidateBlock(uint32_t block_index) {
+    checkBlock(block_index);
+    clearValid(block_index);
+}
+
+void CacheMemory::validateBlock(uint32_t block_index) {
+    checkBlock(block_index);
+    setValid(block_index);
+}
+
+bool CacheMemory::isBlockValid(uint32_t block_index) const {
+    checkBlock(block_index);
+    return testValid(block_index);
+}
+
+void CacheMemory::invalidateAll() {
+    for (auto& bits : valid_bits) {
+        bits.store(0, std::memory_order_release);
     }
-    memory[block_index].valid = false;
 }
 
-void CacheMemory::validateBlock(uint8_t block_index) {
-    if (block_index >= NUMBER_OF_CACHE_BLOCKS) {
-        throw std::out_of_range("Block index out of range");
+uint32_t CacheMemory::countValid() const {
+    uint32_t valid = 0;
+    for (const auto& bits : valid_bits) {
+        valid += std::popcount(bits.load(std::memory_order_acquire));
     }
-    memory[block_index].valid = true;
+    return valid;
 }
 
-bool CacheMemory::isBlockValid(uint8_t block_index) const {
-    if (block_index >= NUMBER_OF_CACHE_BLOCKS) {
-        throw std::out_of_range("Block index out of range");
+void CacheMemory::validateAll() {
+    for (auto& bits : valid_bits) {
+        bits.store(~uint64_t{0}, std::memory_order_release);
+    }
+    // Keep the bits past the last block clear so countValid stays exact
+    if (num_blocks % 64 != 0) {
+        valid_bits.back().store((uint64_t{1} << (num_blocks % 64)) - 1, std::memory_order_release);
     }
-    return memory[block_index].valid;
+}
+
+void CacheMemory::fill(uint32_t value) {
+    std::fill_n(words.get(), totalWords(), value);
+    validateAll();
 }
 
 void CacheMemory::fillRandom(uint32_t seed) {
     std::mt19937 gen(seed);
     std::uniform_int_distribution<uint32_t> dist;
     
-    for (auto& block : memory) {
-        block.data.resize(WORDS_PER_BLOCK);
-        for (auto& word : block.data) {
-            word = dist(gen);
-        }
-        block.valid = true;
+    uint32_t* word = words.get();
+    for (size_t i = 0; i < totalWords(); i++) {
+        word[i] = dist(gen);
     }
+    validateAll();
 }
 
 bool CacheMemory::loadFromFile(const std::string& filename) {
@@ -93,10 +128,10 @@ bool CacheMemory::loadFromFile(const std::string& filename) {
         }
 
         std::string line;
-        uint8_t current_block = 0;
-        uint8_t current_word = 0;
+        uint32_t current_block = 0;
+        uint32_t current_word = 0;
         
-        while (std::getline(file, line) && current_block < NUMBER_OF_CACHE_BLOCKS) {
+        while (std::getline(file, line) && current_block < num_blocks) {
             // Clean the line
             line.erase(0, line.find_first_not_of(" \t\n\r\f\v"));
             line.erase(line.find_last_not_of(" \t\n\r\f\v") + 1);
@@ -114,16 +149,11 @@ bool CacheMemory::loadFromFile(const std::string& filename) {
                 
                 uint32_t value = std::stoul(line, nullptr, 16);
                 
-                // Ensure the block has space
-                if (memory[current_block].data.size() < WORDS_PER_BLOCK) {
-                    memory[current_block].data.resize(WORDS_PER_BLOCK);
-                }
-                
-                memory[current_block].data[current_word] = value;
-                memory[current_block].valid = true;
+                blockPtr(current_block)[current_word] = value;
+                setValid(current_block);
                 
                 current_word++;
-                if (current_word >= WORDS_PER_BLOCK) {
+                if (current_word >= words_per_block) {
                     current_word = 0;
                     current_block++;
                 }
@@ -147,17 +177,12 @@ bool CacheMemory::saveToFile(const std::string& filename) {
         
         file << std::hex << std::uppercase << std::setfill('0');
         
-        for (const auto& block : memory) {
-            if (block.data.size() != WORDS_PER_BLOCK) {
-                continue; // Block not initialized correctly
-            }
+        const uint32_t* word = words.get();
+        for (size_t i = 0; i < totalWords(); i++) {
+            file << "0x" << std::setw(8) << word[i] << "\n";
             
-            for (const auto& word : block.data) {
-                file << "0x" << std::setw(8) << word << "\n";
-                
-                if (!file) {
-                    return false; // Write error
-                }
+            if (!file) {
+                return false; // Write error
             }
         }
         
@@ -169,8 +194,8 @@ bool CacheMemory::saveToFile(const std::string& filename) {
 
 void CacheMemory::showInfo() const {
     std::cout << "Cache Memory:\n";
-    std::cout << " - Total blocks: " << std::dec << (int)NUMBER_OF_CACHE_BLOCKS << "\n";
-    std::cout << " - Words per block: " << (int)WORDS_PER_BLOCK << "\n";
+    std::cout << " - Total blocks: " << std::dec << num_blocks << "\n";
+    std::cout << " - Words per block: " << words_per_block << "\n";
     std::cout << " - Word size: 32 bits (4 bytes)\n";
-    std::cout << " - Total size: " << (NUMBER_OF_CACHE_BLOCKS * WORDS_PER_BLOCK * 4) << " bytes\n";
+    std::cout << " - Total size: " << (static_cast<uint64_t>(num_blocks) * words_per_block * 4) << " bytes\n";
 }
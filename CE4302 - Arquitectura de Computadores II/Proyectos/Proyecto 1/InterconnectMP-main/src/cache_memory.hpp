@@ -2,6 +2,10 @@
 #define CACHE_MEMORY_HPP
 
 #include <vector>
+#include <atomic>
+#include <span>
+#include <memory>
+#include <new>
 #include <cstdint>
 #include <fstream>
 #include <random>
@@ -10,48 +14,93 @@
 #include "constants.hpp"
 
 /**
- * @brief Structure representing a block of memory in the cache.
- * 
- * Contains data and a validity flag.
+ * @brief Deleter for the cache-line aligned word array of CacheMemory.
  */
-struct MemoryBlock {
-    std::vector<uint32_t> data;     // 4 words of 32 bits (16 bytes total)
-    bool valid;                     // Validity bit
-    
-    /**
-     * @brief Constructor initializing the block with 4 words set to zero.
-     */
-    MemoryBlock() : data(4, 0), valid(true) {}
+struct AlignedWordsDeleter {
+    void operator()(uint32_t* words) const {
+        ::operator delete[](words, std::align_val_t(CACHE_LINE_SIZE));
+    }
 };
 
 /**
  * @brief Class representing cache memory with block-level operations.
  * 
+ * All blocks live in one contiguous, cache-line aligned word array (block i
+ * starts at word i * words_per_block) and validity is kept in a packed
+ * bitmap, so whole-cache operations are plain loops over flat arrays. The
+ * bitmap words are atomic: the interconnect thread invalidates blocks while
+ * the PE thread fills neighbouring blocks of the same word.
  * Provides methods for reading and writing blocks or individual words within blocks,
  * as well as loading and saving cache contents from/to files.
  */
 class CacheMemory {
 private:
-    std::vector<MemoryBlock> memory;
+    uint32_t num_blocks;                // Number of blocks in the cache
+    uint32_t words_per_block;           // 32-bit words per block
+    std::unique_ptr<uint32_t[], AlignedWordsDeleter> words;  // num_blocks * words_per_block words
+    std::vector<std::atomic<uint64_t>> valid_bits; // One validity bit per block
+
+    /**
+     * @brief Gets the number of words of the cache.
+     */
+    size_t totalWords() const { return static_cast<size_t>(num_blocks) * words_per_block; }
+
+    /**
+     * @brief Gets a pointer to the first word of a block (no checks).
+     */
+    uint32_t* blockPtr(uint32_t block_index) const { return words.get() + static_cast<size_t>(block_index) * words_per_block; }
+
+    void setValid(uint32_t block_index) {
+        valid_bits[block_index >> 6].fetch_or(uint64_t{1} << (block_index & 63), std::memory_order_release);
+    }
+    void clearValid(uint32_t block_index) {
+        valid_bits[block_index >> 6].fetch_and(~(uint64_t{1} << (block_index & 63)), std::memory_order_release);
+    }
+    bool testValid(uint32_t block_index) const {
+        return (valid_bits[block_index >> 6].load(std::memory_order_acquire) >> (block_index & 63)) & 1;
+    }
+
+    /**
+     * @brief Marks every block valid.
+     */
+    void validateAll();
+
+    /**
+     * @brief Throws if a block index is out of range.
+     */
+    void checkBlock(uint32_t block_index) const;
     
 public:
     /**
-     * @brief Constructor initializing cache memory with NUMBER_OF_CACHE_BLOCKS blocks.
+     * @brief Constructor initializing cache memory with the given geometry.
      * 
-     * Each block is initialized by the MemoryBlock constructor.
+     * Every word starts at zero and every block starts valid.
+     *
+     * @param blocks Number of blocks (default: NUMBER_OF_CACHE_BLOCKS)
+     * @param block_words Words per block (default: WORDS_PER_BLOCK)
+     */
+    CacheMemory(uint32_t blocks = NUMBER_OF_CACHE_BLOCKS, uint32_t block_words = WORDS_PER_BLOCK);
+
+    /**
+     * @brief Gets the number of blocks in the cache.
      */
-    CacheMemory() : memory(NUMBER_OF_CACHE_BLOCKS) {}
+    uint32_t numBlocks() const { return num_blocks; }
 
     /**
-     * @brief Writes a complete block (4 words of 32 bits) to the cache.
+     * @brief Gets the number of 32-bit words per block.
+     */
+    uint32_t wordsPerBlock() const { return words_per_block; }
+
+    /**
+     * @brief Writes a complete block (words_per_block words of 32 bits) to the cache.
      * 
      * @param block_index Index of the block to write
-     * @param words Vector of 4 words to write into the block
+     * @param words words_per_block words to write into the block
      * 
      * @throws std::out_of_range if block index is out of range
-     * @throws std::invalid_argument if the number of words is not exactly 4
+     * @throws std::invalid_argument if the number of words is not exactly words_per_block
      */
-    void writeBlock(uint8_t block_index, const std::vector<uint32_t>& words);
+    void writeBlock(uint32_t block_index, std::span<const uint32_t> words);
 
     /**
      * @brief Writes a specific word within a block.
@@ -62,18 +111,28 @@ public:
      * 
      * @throws std::out_of_range if block index or word offset is out of range
      */
-    void writeWord(uint8_t block_index, uint8_t word_offset, uint32_t value);
+    void writeWord(uint32_t block_index, uint32_t word_offset, uint32_t value);
 
     /**
-     * @brief Reads a complete block (4 words of 32 bits) from the cache.
+     * @brief Reads a complete block (words_per_block words of 32 bits) from the cache.
      * 
      * @param block_index Index of the block to read
-     * @return Reference to the vector of words in the block
+     * @return View of the words of the block
      * 
      * @throws std::out_of_range if block index is out of range
      * @throws std::runtime_error if attempting to read an invalid block
      */
-    const std::vector<uint32_t>& readBlock(uint8_t block_index) const;
+    std::span<const uint32_t> readBlock(uint32_t block_index) const;
+
+    /**
+     * @brief Gets a block for in-place writing and marks it valid.
+     * 
+     * @param block_index Index of the block
+     * @return Writable view of the words of the block
+     * 
+     * @throws std::out_of_range if block index is out of range
+     */
+    std::span<uint32_t> writableBlock(uint32_t block_index);
 
     /**
      * @brief Reads a specific word from a block.
@@ -85,7 +144,7 @@ public:
      * @throws std::out_of_range if block index or word offset is out of range
      * @throws std::runtime_error if attempting to read an invalid block
      */
-    uint32_t readWord(uint8_t block_index, uint8_t word_offset) const;
+    uint32_t readWord(uint32_t block_index, uint32_t word_offset) const;
 
     /**
      * @brief Invalidates a specific block.
@@ -94,7 +153,7 @@ public:
      * 
      * @throws std::out_of_range if block index is out of range
      */
-    void invalidateBlock(uint8_t block_index);
+    void invalidateBlock(uint32_t block_index);
 
     /**
      * @brief Validates a specific block.
@@ -103,7 +162,7 @@ public:
      * 
      * @throws std::out_of_range if block index is out of range
      */
-    void validateBlock(uint8_t block_index);
+    void validateBlock(uint32_t block_index);
 
     /**
      * @brief Checks if a block is valid.
@@ -113,7 +172,22 @@ public:
      * 
      * @throws std::out_of_range if block index is out of range
      */
-    bool isBlockValid(uint8_t block_index) const;
+    bool isBlockValid(uint32_t block_index) const;
+
+    /**
+     * @brief Invalidates every block.
+     */
+    void invalidateAll();
+
+    /**
+     * @brief Counts the valid blocks.
+     */
+    uint32_t countValid() const;
+
+    /**
+     * @brief Sets every word to a value and marks every block valid.
+     */
+    void fill(uint32_t value);
 
     /**
      * @brief Fills the entire cache with random values.
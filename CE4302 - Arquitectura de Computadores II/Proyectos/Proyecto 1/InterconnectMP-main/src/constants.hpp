@@ -2,13 +2,60 @@
 #define CONSTANTS_HPP
 
 #include <cstdint>
+#include <cstddef>
 
-const uint16_t SHARED_MEMORY_SIZE = 4096;       // 4096 32-bit positions
-const uint8_t NUMBER_OF_CACHE_BLOCKS = 128;     // 128 blocks
-const uint8_t WORDS_PER_BLOCK = 4;              // 4 32-bit words per block (16 bytes)
+// Default sizes, overridable at runtime through SystemConfig
+const uint32_t SHARED_MEMORY_SIZE = 4096;       // 4096 32-bit positions
+const uint32_t NUMBER_OF_CACHE_BLOCKS = 128;    // 128 blocks
+const uint32_t WORDS_PER_BLOCK = 4;             // 4 32-bit words per block (16 bytes)
 
-const uint8_t MIN_NUM_PES = 2;
-const uint8_t MAX_NUM_PES = 16;
-const uint8_t DEFAULT_NUM_PES = 8;
+const uint32_t MAX_SHARED_MEMORY_SIZE = 1u << 28;   // 1 GiB of 32-bit positions
+const uint32_t MAX_CACHE_WORDS = 1u << 24;          // 64 MiB of cache per PE
+
+const uint32_t DEFAULT_CACHE_SETS = 32;         // Set-associative cache mode
+const uint32_t DEFAULT_CACHE_WAYS = 4;
+const uint32_t DEFAULT_LINE_WORDS = 4;
+const uint32_t MAX_CACHE_WAYS = 64;
+const uint32_t DEFAULT_MSHRS = 1;                // Outstanding requests per PE (1: blocking PE)
+const uint32_t MAX_MSHRS = 64;
+
+const uint32_t DEFAULT_MEMORY_BANKS = 8;        // Address-interleaved shared memory banks
+const uint32_t MAX_MEMORY_BANKS = 1024;
+const uint32_t DEFAULT_INTERCONNECT_WORKERS = 1; // Interconnect threads (address-sharded)
+const uint32_t MAX_INTERCONNECT_WORKERS = 64;
+const uint32_t INTERCONNECT_SHARD_BLOCKS = 8;   // Cache blocks per address shard of a worker
+
+const uint16_t MIN_NUM_PES = 2;
+const uint16_t MAX_NUM_PES = 4096;
+const uint16_t DEFAULT_NUM_PES = 8;
+const uint32_t NUM_QOS_LEVELS = 256;            // 8-bit QoS values
+const uint32_t MESSAGE_HEADER_BYTES = 8;        // Header of a message, used to size it for arbitration
+const uint32_t DRR_QUANTUM_BYTES = 64;          // Credit each PE earns per deficit round-robin turn
+const uint32_t HISTOGRAM_SUB_BUCKET_BITS = 5;   // Stats histograms: 32 buckets per power of two (~3% error)
+const uint32_t HISTOGRAM_SUB_BUCKETS = 1u << HISTOGRAM_SUB_BUCKET_BITS;
+const uint32_t HISTOGRAM_MAX_BUCKETS = (64 - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS;
+const size_t TRACE_BUFFER_SPANS = 1 << 16;      // Spans kept per thread by the request tracer (ring)
+const uint16_t INTERCONNECT_ID = 0xFFFF;        // src/dest value used by the interconnect
+const uint16_t NUM_WORKLOAD_FILES = 16;         // inst_pe_N.txt files shipped in resources
+const uint64_t DEFAULT_TRAFFIC_LENGTH = 10000;   // Synthetic instructions per PE
+const uint32_t TRAFFIC_HOTSPOT_PERCENT = 80;    // Share of the hotspot accesses that go to the hot blocks
+const uint32_t TRAFFIC_HOTSPOT_BLOCKS = 16;
+const uint32_t TRAFFIC_BUFFER_BLOCKS = 64;      // Producer-consumer buffer of each PE pair
+const uint32_t TRAFFIC_MIGRATORY_BLOCKS = 8;    // Blocks migrating between the PEs
+
+const uint32_t FLIT_WORDS = 4;                      // 32-bit payload words carried by one network flit
+const size_t MAX_REPORTED_LINKS = 16;               // Links listed in the interconnect stats
+const size_t MAX_LINK_RESERVATIONS = 4096;          // Reserved intervals remembered per network link
+
+const size_t CACHE_LINE_SIZE = 64;                  // Host cache line size (bytes), used for padding
+const size_t INTERCONNECT_QUEUE_CAPACITY = 1024;    // Slots of the interconnect ingress ring buffer
+const size_t DEFAULT_IDLE_SPIN_LIMIT = 2000;        // Empty polls before the interconnect parks (hybrid wait)
+const size_t LOGGER_RING_CAPACITY = 512;            // Records buffered per producer thread (async logging)
+const uint32_t LOGGER_IDLE_SLEEP_US = 500;          // Sleep of the async log writer when every ring is empty
+const size_t EVENT_LOG_BUFFER_BYTES = 1 << 16;      // Binary message log bytes buffered before each write
+const char EVENT_LOG_MAGIC[8] = {'I', 'M', 'P', 'E', 'V', 'L', 'G', '1'}; // First bytes of a binary message log
+const uint32_t MAX_EVENT_TEXT_BYTES = 1 << 20;     // Longest text accepted by the event log decoder
+const char INSTRUCTION_TRACE_MAGIC[8] = {'I', 'M', 'P', 'T', 'R', 'A', 'C', 'E'}; // First bytes of a compiled workload
+const uint32_t INSTRUCTION_TRACE_VERSION = 1;
 
 #endif // CONSTANTS_HPP
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include <algorithm>
+#include "directory.hpp"
+
+void Directory::reset(uint32_t entries, uint16_t pes, bool all_present) {
+    num_entries = entries;
+    num_pes = pes;
+    words_per_entry = (static_cast<uint32_t>(pes) + 63) / 64;
+
+    size_t total_words = static_cast<size_t>(entries) * words_per_entry;
+    bits.reset(new std::atomic<uint64_t>[total_words]);
+
+    for (size_t i = 0; i < total_words; i++) {
+        uint64_t initial = 0;
+        if (all_present) {
+            // Every PE of this word, the last word being partially used
+            uint32_t first_pe = static_cast<uint32_t>(i % words_per_entry) * 64;
+            uint32_t pes_in_word = std::min<uint32_t>(64, pes - first_pe);
+            initial = pes_in_word == 64 ? ~uint64_t{0} : (uint64_t{1} << pes_in_word) - 1;
+        }
+        bits[i].store(initial, std::memory_order_relaxed);
+    }
+}
+
+void Directory::keepOnly(uint32_t entry, uint16_t pe) {
+    std::atomic<uint64_t>* row = &bits[static_cast<size_t>(entry) * words_per_entry];
+    for (uint32_t w = 0; w < words_per_entry; w++) {
+        uint64_t keep = (w == pe / 64) ? (uint64_t{1} << (pe % 64)) : 0;
+        row[w].fetch_and(keep, std::memory_order_relaxed);
+    }
+}
+
+uint32_t Directory::countSharers(uint32_t entry, uint16_t except) const {
+    const std::atomic<uint64_t>* row = &bits[static_cast<size_t>(entry) * words_per_entry];
+    uint32_t count = 0;
+    for (uint32_t w = 0; w < words_per_entry; w++) {
+        count += std::popcount(row[w].load(std::memory_order_relaxed));
+    }
+    return count - (isSharer(entry, except) ? 1 : 0);
+}
@@ -0,0 +1,99 @@
+#ifndef DIRECTORY_HPP
+#define DIRECTORY_HPP
+
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <cstdint>
+
+/**
+ * @brief Full bit-vector directory of the PEs that hold each entry.
+ *
+ * Every entry (a shared memory line, or a cache block index) owns one bit
+ * per PE, stored in ceil(num_pes / 64) consecutive 64-bit words. Bits are
+ * atomic so PEs can register themselves while the interconnect walks the
+ * sharers of another entry; a walk reads each word once, so concurrent
+ * updates of the same entry are seen either before or after the walk.
+ */
+class Directory {
+private:
+    uint32_t num_entries = 0;               // Tracked lines or blocks
+    uint32_t num_pes = 0;                   // Bits per entry
+    uint32_t words_per_entry = 0;           // 64-bit words per entry
+    std::unique_ptr<std::atomic<uint64_t>[]> bits;
+
+    std::atomic<uint64_t>& word(uint32_t entry, uint16_t pe) const {
+        return bits[static_cast<size_t>(entry) * words_per_entry + pe / 64];
+    }
+
+public:
+    Directory() = default;
+
+    /**
+     * @brief Allocates the directory.
+     *
+     * @param entries Number of tracked entries.
+     * @param pes Number of PEs.
+     * @param all_present True to start with every PE holding every entry.
+     */
+    void reset(uint32_t entries, uint16_t pes, bool all_present);
+
+    /**
+     * @brief Checks whether the directory has been allocated.
+     */
+    bool enabled() const { return bits != nullptr; }
+
+    uint32_t numEntries() const { return num_entries; }
+
+    /**
+     * @brief Gets the memory used by the sharer bits.
+     */
+    size_t bytes() const { return static_cast<size_t>(num_entries) * words_per_entry * sizeof(uint64_t); }
+
+    void addSharer(uint32_t entry, uint16_t pe) {
+        word(entry, pe).fetch_or(uint64_t{1} << (pe % 64), std::memory_order_relaxed);
+    }
+
+    void removeSharer(uint32_t entry, uint16_t pe) {
+        word(entry, pe).fetch_and(~(uint64_t{1} << (pe % 64)), std::memory_order_relaxed);
+    }
+
+    bool isSharer(uint32_t entry, uint16_t pe) const {
+        return word(entry, pe).load(std::memory_order_relaxed) & (uint64_t{1} << (pe % 64));
+    }
+
+    /**
+     * @brief Removes every sharer except one PE (which keeps its current bit).
+     */
+    void keepOnly(uint32_t entry, uint16_t pe);
+
+    /**
+     * @brief Counts the sharers of an entry, leaving one PE out.
+     *
+     * @param entry Directory entry.
+     * @param except PE not counted (usually the requester).
+     */
+    uint32_t countSharers(uint32_t entry, uint16_t except) const;
+
+    /**
+     * @brief Calls a function with the ID of every sharer of an entry except one PE.
+     *
+     * The function may add or remove sharers of the entry.
+     */
+    template <typename Function>
+    void forEachSharer(uint32_t entry, uint16_t except, Function&& function) const {
+        const std::atomic<uint64_t>* row = &bits[static_cast<size_t>(entry) * words_per_entry];
+        for (uint32_t w = 0; w < words_per_entry; w++) {
+            uint64_t set_bits = row[w].load(std::memory_order_relaxed);
+            while (set_bits != 0) {
+                uint16_t pe = static_cast<uint16_t>(w * 64 + std::countr_zero(set_bits));
+                set_bits &= set_bits - 1;
+                if (pe != except) {
+                    function(pe);
+                }
+            }
+        }
+    }
+};
+
+#endif // DIRECTORY_HPP
@@ -0,0 +1,101 @@
+#include "event_engine.hpp"
+#include "interconnect.hpp"
+#include "processing_element.hpp"
+
+EventSimulator::EventSimulator(Interconnect& ic, const std::vector<ProcessingElement*>& pe_list)
+    : interconnect(ic), pes(pe_list) {}
+
+const EngineStats& EventSimulator::getStats() const {
+    return stats;
+}
+
+void EventSimulator::schedule(uint64_t cycle, EventType type, size_t pe, Message msg) {
+    events.push(Event{cycle, next_seq++, type, pe, std::move(msg)});
+    stats.max_pending_events = std::max(stats.max_pending_events, events.size());
+}
+
+void EventSimulator::handleIssue(const Event& event) {
+    ProcessingElement* pe = pes[event.pe];
+    issue_scheduled[event.pe] = false;
+
+    Message msg;
+    if (pe->issueNext(msg, interconnect.getCycleCosts())) {
+        uint64_t arrival = msg.timestamp;
+        schedule(arrival, EventType::MESSAGE_ARRIVAL, event.pe, std::move(msg));
+
+        // Independent instructions issue back to back while MSHRs are free
+        if (pe->canIssue()) {
+            issue_scheduled[event.pe] = true;
+            schedule(arrival, EventType::PE_ISSUE, event.pe);
+        }
+    } else if (pe->isDone()) {
+        pe->finish();
+    }
+}
+
+void EventSimulator::handleArrival(Event& event) {
+    interconnect.enqueueMessage(std::move(event.msg));
+
+    if (!interconnect_busy) {
+        interconnect_busy = true;
+        schedule(event.cycle, EventType::INTERCONNECT_SERVICE, 0);
+    }
+}
+
+void EventSimulator::handleService(const Event& event) {
+    size_t current_qsize = 0;
+    Message msg;
+
+    if (!interconnect.dequeueMessage(msg, current_qsize)) {
+        interconnect_busy = false;
+        return;
+    }
+
+    Message resp;
+    if (interconnect.handleMessage(msg, current_qsize, resp)) {
+        uint64_t delivery = resp.timestamp;
+        schedule(delivery, EventType::RESPONSE_DELIVERY, msg.src, std::move(resp));
+    }
+    interconnect.waitForStep();
+
+    // The interconnect is free again once its clock has moved past this service
+    schedule(std::max(event.cycle, interconnect.now()), EventType::INTERCONNECT_SERVICE, 0);
+}
+
+void EventSimulator::handleDelivery(Event& event) {
+    ProcessingElement* pe = pes[event.pe];
+    pe->completeResponse(event.msg);
+
+    if (issue_scheduled[event.pe]) return;
+    if (pe->canIssue()) {
+        issue_scheduled[event.pe] = true;
+        schedule(std::max(event.cycle, pe->localCycle()), EventType::PE_ISSUE, event.pe);
+    } else if (pe->isDone()) {
+        pe->finish();
+    }
+}
+
+void EventSimulator::run() {
+    auto wall_start = std::chrono::steady_clock::now();
+
+    issue_scheduled.assign(pes.size(), true);
+    for (size_t i = 0; i < pes.size(); i++) {
+        schedule(0, EventType::PE_ISSUE, i);
+    }
+
+    while (!events.empty()) {
+        Event event = events.popTop();
+        stats.events_processed++;
+        stats.final_cycle = event.cycle;
+
+        switch (event.type) {
+            case EventType::PE_ISSUE: handleIssue(event); break;
+            case EventType::MESSAGE_ARRIVAL: handleArrival(event); break;
+            case EventType::INTERCONNECT_SERVICE: handleService(event); break;
+            case EventType::RESPONSE_DELIVERY: handleDelivery(event); break;
+        }
+    }
+
+    stats.wall_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - wall_start);
+}
@@ -0,0 +1,148 @@
+#ifndef EVENT_ENGINE_HPP
+#define EVENT_ENGINE_HPP
+
+#include <vector>
+#include <queue>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include "message.hpp"
+#include "movable_priority_queue.hpp"
+
+// Forward declarations
+class Interconnect;
+class ProcessingElement;
+
+/**
+ * @brief Kinds of events handled by the discrete-event engine.
+ */
+enum class EventType {
+    PE_ISSUE,               // A PE issues its next instruction
+    MESSAGE_ARRIVAL,        // A request reaches the interconnect queue
+    INTERCONNECT_SERVICE,   // The interconnect arbitrates and services one message
+    RESPONSE_DELIVERY       // A response reaches its PE
+};
+
+/**
+ * @brief Timestamped event of the simulation.
+ *
+ * Events with the same cycle are ordered by their sequence number, which
+ * makes the execution order fully deterministic.
+ */
+struct Event {
+    uint64_t cycle;         // Simulated cycle when the event fires
+    uint64_t seq;           // Insertion order, used to break ties
+    EventType type;         // Kind of event
+    size_t pe;              // Index of the PE involved (PE_ISSUE, RESPONSE_DELIVERY)
+    Message msg;            // Request or response carried by the event
+};
+
+/**
+ * @brief Comparator that puts the earliest event on top of the priority queue.
+ */
+struct EventComparator {
+    bool operator()(const Event& a, const Event& b) const {
+        if (a.cycle != b.cycle) return a.cycle > b.cycle;
+        return a.seq > b.seq;
+    }
+};
+
+/**
+ * @brief Structure to save stats of the discrete-event engine
+ */
+struct EngineStats {
+    size_t events_processed = 0;
+    size_t max_pending_events = 0;
+    uint64_t final_cycle = 0;
+    std::chrono::microseconds wall_time{0};
+
+    std::string getSummary() const {
+        double seconds = wall_time.count() / 1e6;
+        double events_per_sec = seconds > 0 ? events_processed / seconds : 0.0;
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << "\n========= Event Engine Stats =========\n"
+           << "Events Processed:    " << events_processed << "\n"
+           << "Max Pending Events:  " << max_pending_events << "\n"
+           << "Final Cycle:         " << final_cycle << "\n"
+           << "Wall Time (μs):      " << wall_time.count() << "\n"
+           << "Events/sec:          " << events_per_sec << "\n"
+           << "======================================\n";
+        return ss.str();
+    }
+};
+
+/**
+ * @brief Single-threaded discrete-event simulation engine.
+ *
+ * Drives the PEs, the interconnect arbitration and the shared memory
+ * accesses from one timestamped event queue instead of one OS thread per
+ * PE. Results are deterministic and the number of PEs is not bounded by
+ * the number of host threads.
+ */
+class EventSimulator {
+private:
+    Interconnect& interconnect;                 // Interconnect servicing the requests
+    std::vector<ProcessingElement*> pes;        // PEs indexed by ID
+    MovablePriorityQueue<Event, EventComparator> events; // Pending events
+    uint64_t next_seq = 0;                      // Sequence number of the next event
+    bool interconnect_busy = false;             // True while a service event is pending
+    std::vector<bool> issue_scheduled;          // True while a PE has a PE_ISSUE pending
+    EngineStats stats;                          // Stats of the engine
+
+    /**
+     * @brief Adds an event to the queue.
+     *
+     * @param cycle Cycle when the event fires.
+     * @param type Kind of event.
+     * @param pe Index of the PE involved.
+     * @param msg Message carried by the event.
+     */
+    void schedule(uint64_t cycle, EventType type, size_t pe, Message msg = {});
+
+    /**
+     * @brief Lets a PE issue its next instruction at the given cycle.
+     */
+    void handleIssue(const Event& event);
+
+    /**
+     * @brief Queues an arriving request and wakes the interconnect if idle.
+     */
+    void handleArrival(Event& event);
+
+    /**
+     * @brief Arbitrates, services one message and schedules its response.
+     */
+    void handleService(const Event& event);
+
+    /**
+     * @brief Delivers a response and lets the PE continue.
+     */
+    void handleDelivery(Event& event);
+
+public:
+    /**
+     * @brief Constructor for the EventSimulator class.
+     *
+     * @param ic Interconnect servicing the requests.
+     * @param pe_list PEs to simulate, indexed by ID.
+     */
+    EventSimulator(Interconnect& ic, const std::vector<ProcessingElement*>& pe_list);
+
+    /**
+     * @brief Runs the simulation until every PE has executed its workload.
+     */
+    void run();
+
+    /**
+     * @brief Gets the EngineStats struct of the engine.
+     *
+     * @return The EngineStats struct of the engine.
+     */
+    const EngineStats& getStats() const;
+};
+
+#endif // EVENT_ENGINE_HPP
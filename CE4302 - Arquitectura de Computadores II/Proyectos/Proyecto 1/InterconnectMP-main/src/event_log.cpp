@@ -0,0 +1,203 @@
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include "event_log.hpp"
+#include "utils.hpp"
+
+bool EventLog::binary = false;
+
+namespace {
+
+const char* kindHeading(EventKind kind) {
+    switch (kind) {
+        case EventKind::RECEIVED: return "Message received:";
+        case EventKind::SENT: return "Message sent:";
+        case EventKind::DISCARDED: return "Message discarded:";
+        default: return "";
+    }
+}
+
+/**
+ * @brief Formats a timestamp like Logger does.
+ */
+std::string formatTime(uint64_t time_ns) {
+    std::chrono::system_clock::time_point time{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time_ns))};
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    std::tm local{};
+    localtime_r(&seconds, &local);
+    std::stringstream ss;
+    ss << std::put_time(&local, "%Y-%m-%d %X");
+    return ss.str();
+}
+
+/**
+ * @brief Gets the bytes left in a stream, or UINT64_MAX if it cannot seek.
+ */
+uint64_t remainingBytes(std::istream& in) {
+    std::streampos pos = in.tellg();
+    if (pos == std::streampos(-1)) return UINT64_MAX;
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(pos);
+    if (end == std::streampos(-1) || !in) {
+        in.clear();
+        return UINT64_MAX;
+    }
+    return static_cast<uint64_t>(end - pos);
+}
+
+} // namespace
+
+EventLog::EventLog(Logger& text_log, const std::string& filename)
+    : text_log(text_log), filename(filename) {}
+
+EventLog::~EventLog() {
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+void EventLog::message(EventKind kind, const Message& msg, const std::string& detail) {
+    if (!binary) {
+        text_log.log(messageToLog(kindHeading(kind), msg) + detail);
+        return;
+    }
+    append(kind, &msg, detail);
+}
+
+void EventLog::note(const std::string& text) {
+    if (!binary) {
+        text_log.log(text);
+        return;
+    }
+    append(EventKind::NOTE, nullptr, text);
+}
+
+void EventLog::append(EventKind kind, const Message* msg, const std::string& text) {
+    EventRecord record{};
+    record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.kind = kind;
+    record.text_bytes = static_cast<uint32_t>(text.size());
+    if (msg != nullptr) {
+        record.addr = msg->addr;
+        record.size = msg->size;
+        record.cache_line = msg->cache_line;
+        record.start_cache_line = msg->start_cache_line;
+        record.num_of_cache_lines = msg->num_of_cache_lines;
+        record.data_words = msg->data.size();
+        record.src = msg->src;
+        record.dest = msg->dest;
+        record.type = static_cast<uint8_t>(msg->type);
+        record.qos = msg->qos;
+        record.status = msg->status;
+    }
+    size_t data_bytes = static_cast<size_t>(record.data_words) * sizeof(uint32_t);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file == nullptr) {
+        file = std::fopen(filename.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error("Failed to open event log: " + filename);
+        }
+        std::fwrite(EVENT_LOG_MAGIC, 1, sizeof(EVENT_LOG_MAGIC), file);
+        buffer.reserve(EVENT_LOG_BUFFER_BYTES);
+    }
+
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(record) + data_bytes + text.size());
+    char* out = buffer.data() + offset;
+    std::memcpy(out, &record, sizeof(record));
+    if (data_bytes > 0) {
+        std::memcpy(out + sizeof(record), msg->data.data(), data_bytes);
+    }
+    std::memcpy(out + sizeof(record) + data_bytes, text.data(), text.size());
+
+    if (buffer.size() >= EVENT_LOG_BUFFER_BYTES) {
+        flushLocked();
+    }
+}
+
+void EventLog::flushLocked() {
+    if (file == nullptr || buffer.empty()) return;
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+        throw std::runtime_error("Failed to write event log: " + filename);
+    }
+    buffer.clear();
+    std::fflush(file);
+}
+
+void EventLog::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+size_t EventLog::decode(std::istream& in, std::ostream& out) {
+    char magic[sizeof(EVENT_LOG_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, EVENT_LOG_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not an event log");
+    }
+
+    size_t records = 0;
+    EventRecord record;
+    std::vector<uint32_t> words;
+    std::string text;
+    uint64_t remaining = remainingBytes(in);
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        // Lengths come from the file: check them before allocating
+        uint64_t body_bytes = static_cast<uint64_t>(record.data_words) * sizeof(uint32_t) + record.text_bytes;
+        if (remaining != UINT64_MAX) {
+            remaining -= sizeof(record);
+        }
+        if (record.data_words > MAX_CACHE_WORDS || record.text_bytes > MAX_EVENT_TEXT_BYTES) {
+            throw std::runtime_error("Corrupt event log (record " + std::to_string(records) + " is too long)");
+        }
+        if (body_bytes > remaining) {
+            throw std::runtime_error("Truncated event log (record " + std::to_string(records) + ")");
+        }
+        if (remaining != UINT64_MAX) {
+            remaining -= body_bytes;
+        }
+
+        words.resize(record.data_words);
+        text.resize(record.text_bytes);
+        in.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(uint32_t)));
+        in.read(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!in) {
+            throw std::runtime_error("Truncated event log (record " + std::to_string(records) + ")");
+        }
+
+        std::string entry;
+        if (record.kind == EventKind::NOTE) {
+            entry = text;
+        } else {
+            Message msg{};
+            msg.type = static_cast<MessageType>(record.type);
+            msg.src = record.src;
+            msg.dest = record.dest;
+            msg.addr = record.addr;
+            msg.size = record.size;
+            msg.cache_line = record.cache_line;
+            msg.start_cache_line = record.start_cache_line;
+            msg.num_of_cache_lines = record.num_of_cache_lines;
+            msg.qos = record.qos;
+            msg.status = record.status;
+            msg.data.append(words);
+            entry = messageToLog(kindHeading(record.kind), msg) + text;
+        }
+        out << "\n[" << formatTime(record.time_ns) << "] " << entry << "\n";
+        records++;
+    }
+    if (in.gcount() != 0) {
+        throw std::runtime_error("Truncated event log (record " + std::to_string(records) + ")");
+    }
+    return records;
+}
@@ -0,0 +1,138 @@
+#ifndef EVENT_LOG_HPP
+#define EVENT_LOG_HPP
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+#include "constants.hpp"
+#include "message.hpp"
+#include "logger.hpp"
+
+/**
+ * @brief Kind of a message log entry.
+ */
+enum class EventKind : uint8_t {
+    NOTE,               // Free text ("Started processing messages")
+    RECEIVED,           // "Message received:"
+    SENT,               // "Message sent:"
+    DISCARDED           // "Message discarded:" followed by the reason
+};
+
+/**
+ * @brief Fixed-size header of a binary event record.
+ *
+ * Followed by data_words raw payload words and text_bytes bytes of text
+ * (the note, or the reason lines of a discarded message).
+ */
+struct EventRecord {
+    uint64_t time_ns;               // Wall clock, nanoseconds since the epoch
+    uint32_t addr;
+    uint32_t size;
+    uint32_t cache_line;
+    uint32_t start_cache_line;
+    uint32_t num_of_cache_lines;
+    uint32_t data_words;
+    uint32_t text_bytes;
+    uint16_t src;
+    uint16_t dest;
+    EventKind kind;
+    uint8_t type;                   // MessageType
+    uint8_t qos;
+    uint8_t status;
+};
+
+static_assert(sizeof(EventRecord) == 48, "EventRecord is part of the file format");
+
+/**
+ * @brief Message log of a simulator component, written as text or binary.
+ *
+ * In text mode (the default) every entry is formatted by messageToLog and
+ * written through the component Logger, as before. In binary mode the
+ * message fields are copied into a fixed-size EventRecord plus the raw
+ * payload words and appended to a buffered file (EVENT_LOG_MAGIC first), so
+ * no formatting happens while the simulation runs. decode() renders a binary
+ * log with the same layout as the text log.
+ *
+ * The mode is global and must be chosen before the simulation starts.
+ * Thread-safe; the binary file is opened on the first entry and flushed
+ * when the buffer fills up and on destruction.
+ */
+class EventLog {
+private:
+    Logger& text_log;               // Destination in text mode
+    std::string filename;           // Destination in binary mode
+    std::FILE* file = nullptr;
+    std::vector<char> buffer;       // Records not yet written
+    std::mutex mutex;               // Guards file and buffer
+
+    static bool binary;             // Binary mode of every event log
+
+    /**
+     * @brief Appends one record to the binary log.
+     */
+    void append(EventKind kind, const Message* msg, const std::string& text);
+
+    /**
+     * @brief Writes the buffer to the file. The mutex must be held.
+     */
+    void flushLocked();
+
+public:
+    /**
+     * @brief EventLog constructor.
+     *
+     * @param text_log Logger of the text mode.
+     * @param filename File of the binary mode.
+     */
+    EventLog(Logger& text_log, const std::string& filename);
+
+    /**
+     * @brief EventLog destructor. Writes the buffered records.
+     */
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * @brief Selects binary (true) or text (false) logging for every event log.
+     */
+    static void setBinary(bool enabled) { binary = enabled; }
+
+    static bool isBinary() { return binary; }
+
+    /**
+     * @brief Logs a message.
+     *
+     * @param kind RECEIVED, SENT or DISCARDED.
+     * @param msg The message.
+     * @param detail Lines appended after the message (the reason of a discard).
+     */
+    void message(EventKind kind, const Message& msg, const std::string& detail = "");
+
+    /**
+     * @brief Logs a line of text.
+     */
+    void note(const std::string& text);
+
+    /**
+     * @brief Writes the buffered records to the file.
+     */
+    void flush();
+
+    /**
+     * @brief Renders a binary event log in the text log layout.
+     *
+     * @param in Binary log.
+     * @param out Destination of the text.
+     * @return Number of records decoded.
+     * @throws std::runtime_error if the input is not a complete event log or
+     *         a record is longer than the remaining input or the decoder limits.
+     */
+    static size_t decode(std::istream& in, std::ostream& out);
+};
+
+#endif // EVENT_LOG_HPP
@@ -0,0 +1,62 @@
+#include <bit>
+#include <cmath>
+#include <algorithm>
+#include "histogram.hpp"
+
+size_t Histogram::bucketOf(uint64_t value) {
+    if (value < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    // Keep the top HISTOGRAM_SUB_BUCKET_BITS + 1 bits: (value >> shift) is in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+    unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - HISTOGRAM_SUB_BUCKET_BITS;
+    return static_cast<size_t>(shift) * HISTOGRAM_SUB_BUCKETS + static_cast<size_t>(value >> shift);
+}
+
+uint64_t Histogram::bucketHigh(size_t bucket) {
+    if (bucket < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned shift = static_cast<unsigned>(bucket / HISTOGRAM_SUB_BUCKETS) - 1;
+    uint64_t top = bucket % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    size_t bucket = bucketOf(value);
+    if (bucket >= counts.size()) {
+        counts.resize(bucket + 1, 0);
+    }
+    counts[bucket]++;
+    samples++;
+    total += value;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+}
+
+void Histogram::merge(const Histogram& other) {
+    if (other.counts.size() > counts.size()) {
+        counts.resize(other.counts.size(), 0);
+    }
+    for (size_t bucket = 0; bucket < other.counts.size(); bucket++) {
+        counts[bucket] += other.counts[bucket];
+    }
+    samples += other.samples;
+    total += other.total;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+}
+
+uint64_t Histogram::percentile(double fraction) const {
+    if (samples == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * samples));
+    rank = std::clamp<uint64_t>(rank, 1, samples);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < counts.size(); bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return std::clamp(bucketHigh(bucket), min_value, max_value);
+        }
+    }
+    return max_value;
+}
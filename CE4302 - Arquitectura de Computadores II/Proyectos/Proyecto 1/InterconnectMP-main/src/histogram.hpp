@@ -0,0 +1,71 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include "constants.hpp"
+
+/**
+ * @brief Log-linear histogram of non-negative integer samples (HDR-style).
+ *
+ * Values below 2 * HISTOGRAM_SUB_BUCKETS get a bucket each; above that,
+ * every power-of-two range is split into HISTOGRAM_SUB_BUCKETS equal
+ * buckets, so a reported percentile is at most 1/HISTOGRAM_SUB_BUCKETS
+ * above the exact one. Recording is O(1) and the memory depends only on
+ * the largest value seen (at most HISTOGRAM_MAX_BUCKETS counters), not on
+ * the number of samples. Count, sum, min and max are exact.
+ */
+class Histogram {
+private:
+    std::vector<uint64_t> counts;           // Samples per bucket, up to the highest bucket used
+    uint64_t samples = 0;
+    uint64_t total = 0;                     // Sum of the samples
+    uint64_t min_value = std::numeric_limits<uint64_t>::max();
+    uint64_t max_value = 0;
+
+    /**
+     * @brief Gets the bucket of a value.
+     */
+    static size_t bucketOf(uint64_t value);
+
+    /**
+     * @brief Gets the highest value counted by a bucket.
+     */
+    static uint64_t bucketHigh(size_t bucket);
+
+public:
+    /**
+     * @brief Counts one sample.
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief Adds the samples of another histogram.
+     */
+    void merge(const Histogram& other);
+
+    /**
+     * @brief Gets a nearest-rank percentile.
+     *
+     * @param fraction Fraction of the samples at or below the result (e.g. 0.99).
+     * @return Upper bound of the bucket holding that rank (never above the
+     *         max), or 0 without samples.
+     */
+    uint64_t percentile(double fraction) const;
+
+    uint64_t count() const { return samples; }
+    uint64_t sum() const { return total; }
+    uint64_t min() const { return samples > 0 ? min_value : 0; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return samples > 0 ? static_cast<double>(total) / samples : 0.0; }
+    bool empty() const { return samples == 0; }
+
+    /**
+     * @brief Gets the number of bucket counters allocated.
+     */
+    size_t buckets() const { return counts.size(); }
+};
+
+#endif // HISTOGRAM_HPP
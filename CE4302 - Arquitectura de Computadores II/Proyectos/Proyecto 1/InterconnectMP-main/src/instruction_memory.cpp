@@ -1,135 +1,325 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "instruction_memory.hpp"
+#include "traffic_generator.hpp"
+
+namespace {
+
+/**
+ * @brief Splits the next operand (separated by spaces, tabs or commas) off a line.
+ */
+std::string_view nextToken(std::string_view& line) {
+    size_t start = line.find_first_not_of(" \t\r,");
+    if (start == std::string_view::npos) {
+        line = {};
+        return {};
+    }
+    size_t end = line.find_first_of(" \t\r,", start);
+    if (end == std::string_view::npos) {
+        end = line.size();
+    }
+    std::string_view token = line.substr(start, end - start);
+    line.remove_prefix(end);
+    return token;
+}
+
+/**
+ * @brief Parses a hexadecimal operand, with or without a 0x prefix.
+ *
+ * @return false if the token is not a hexadecimal number.
+ */
+bool parseHex(std::string_view token, uint32_t& value) {
+    if (token.size() >= 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')) {
+        token.remove_prefix(2);
+    }
+    if (token.empty() || token.size() > 8) {
+        return false;
+    }
+    uint32_t result = 0;
+    for (char c : token) {
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else return false;
+        result = (result << 4) | static_cast<uint32_t>(digit);
+    }
+    value = result;
+    return true;
+}
+
+bool equalsIgnoreCase(std::string_view token, const char* name) {
+    return token.size() == std::strlen(name) && strncasecmp(token.data(), name, token.size()) == 0;
+}
+
+/**
+ * @brief Checks whether a record type is one of the workload instructions.
+ */
+bool isInstructionType(uint8_t type) {
+    switch (static_cast<MessageType>(type)) {
+        case MessageType::READ_MEM:
+        case MessageType::WRITE_MEM:
+        case MessageType::BROADCAST_INVALIDATE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+MappedFile::~MappedFile() {
+    if (base != nullptr) {
+        munmap(base, length);
+    }
+}
+
+bool MappedFile::open(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    base = mapped;
+    length = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+InstructionMemory::InstructionMemory() = default;
+
+InstructionMemory::~InstructionMemory() = default;
+
+void InstructionMemory::addSegment(const InstructionRecord* records, size_t count) {
+    if (count == 0) return;
+    bool was_empty = segment == segments.size();
+    segments.push_back({records, count});
+    if (was_empty) {
+        decodeHead(records[0]);
+    }
+}
+
+void InstructionMemory::setGenerator(std::unique_ptr<TrafficGenerator> source, uint64_t count) {
+    generator = std::move(source);
+    generated_left = count;
+    if (segment == segments.size() && generated_left > 0) {
+        decodeHead(generator->next());
+    }
+}
+
+void InstructionMemory::decodeHead(const InstructionRecord& record) {
+    head = Message{};
+    head.type = static_cast<MessageType>(record.type);
+    head.src = INTERCONNECT_ID;
+    head.dest = INTERCONNECT_ID;
+    head.addr = record.addr;
+    head.size = 0x0000;
+    head.cache_line = 0x00;
+    head.start_cache_line = 0x00;
+    head.num_of_cache_lines = 0x00;
+    head.qos = 0x00;
+    head.status = 0x0;
+
+    switch (head.type) {
+        case MessageType::READ_MEM: head.size = record.operand; break;
+        case MessageType::WRITE_MEM:
+            head.start_cache_line = record.operand;
+            head.num_of_cache_lines = record.count;
+            break;
+        case MessageType::BROADCAST_INVALIDATE: head.cache_line = record.operand; break;
+        default: break;
+    }
+}
 
 bool InstructionMemory::loadFromFile(const std::string& filename) {
+    char magic[sizeof(INSTRUCTION_TRACE_MAGIC)] = {};
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.read(magic, sizeof(magic));
+    }
+    if (std::memcmp(magic, INSTRUCTION_TRACE_MAGIC, sizeof(magic)) == 0) {
+        return loadBinary(filename);
+    }
+    return loadText(filename);
+}
+
+bool InstructionMemory::loadBinary(const std::string& filename) {
+    auto mapping = std::make_unique<MappedFile>();
+    if (!mapping->open(filename) || mapping->size() < sizeof(InstructionTraceHeader)) {
+        return false;
+    }
+
+    InstructionTraceHeader header;
+    std::memcpy(&header, mapping->data(), sizeof(header));
+    if (header.version != INSTRUCTION_TRACE_VERSION || header.record_bytes != sizeof(InstructionRecord) ||
+        header.records != (mapping->size() - sizeof(header)) / sizeof(InstructionRecord) ||
+        (mapping->size() - sizeof(header)) % sizeof(InstructionRecord) != 0) {
+        return false;
+    }
+
+    // The header keeps the records 8-byte aligned within the page-aligned mapping
+    auto records = reinterpret_cast<const InstructionRecord*>(mapping->data() + sizeof(header));
+    mappings.push_back(std::move(mapping));
+
+    // Records of any other type are skipped by ending the segment before them
+    size_t first = 0;
+    for (size_t i = 0; i < header.records; i++) {
+        if (isInstructionType(records[i].type)) continue;
+        addSegment(records + first, i - first);
+        rejected++;
+        first = i + 1;
+    }
+    addSegment(records + first, header.records - first);
+    return true;
+}
+
+bool InstructionMemory::loadText(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         return false;
     }
 
-    std::map<std::string, MessageType> instructionMap = {
-        {"WRITE_MEM", MessageType::WRITE_MEM},
-        {"READ_MEM", MessageType::READ_MEM},
-        {"BROADCAST_INVALIDATE", MessageType::BROADCAST_INVALIDATE}
-    };
+    std::vector<InstructionRecord> records;
+    std::string text;
+    while (std::getline(file, text)) {
+        std::string_view line = text;
 
-    std::string line;
-    while (std::getline(file, line)) {
         // Remove comments
-        size_t commentPos = line.find("//");
-        if (commentPos != std::string::npos) {
-            line = line.substr(0, commentPos);
+        size_t comment_pos = line.find("//");
+        if (comment_pos != std::string_view::npos) {
+            line = line.substr(0, comment_pos);
         }
 
-        // Remove leading and trailing whitespaces
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-
-        // Skip empty lines
-        if (line.empty()) {
+        std::string_view name = nextToken(line);
+        if (name.empty()) {
             continue;
         }
 
-        // Convert to uppercase
-        std::string upperLine = line;
-        std::transform(upperLine.begin(), upperLine.end(), upperLine.begin(),
-                       [](unsigned char c){ return std::toupper(c); });
-
-        // Process the line
-        std::istringstream iss(upperLine);
-        std::string instructionType;
-        iss >> instructionType;
-
-        Message msg; // Default values
-        msg.type = instructionMap[instructionType];
-        msg.src = 0xFF;
-        msg.dest = 0xFF;
-        msg.addr = 0x0000;
-        msg.size = 0x0000;
-        msg.cache_line = 0x00;
-        msg.start_cache_line = 0x00;
-        msg.num_of_cache_lines = 0x00;
-        msg.qos = 0x00;
-        msg.status = 0x0;
-        msg.data = {};
-
-        try {
-            switch (msg.type) {
-                case MessageType::WRITE_MEM: {
-                    // Format: WRITE_MEM addr, start_cache_line, num_of_cache_lines
-                    std::string addrStr, startStr, numStr;
-                    
-                    iss >> std::hex >> addrStr 
-                        >> std::hex >> startStr
-                        >> std::hex >> numStr;
-                    
-                    // Remove 0x if exists
-                    addrStr = (addrStr.size() >= 2 && addrStr.find("0X") == 0) ? addrStr.substr(2) : addrStr;
-                    startStr = (startStr.size() >= 2 && startStr.find("0X") == 0) ? startStr.substr(2) : startStr;
-                    numStr = (numStr.size() >= 2 && numStr.find("0X") == 0) ? numStr.substr(2) : numStr;
-                    
-                    // Remove comma if exists
-                    addrStr = (addrStr.size() > 0 && addrStr.back() == ',') ? addrStr.substr(0, addrStr.size() - 1) : addrStr;
-                    startStr = (startStr.size() > 0 && startStr.back() == ',') ? startStr.substr(0, startStr.size() - 1) : startStr;
-                    numStr = (numStr.size() > 0 && numStr.back() == ',') ? numStr.substr(0, numStr.size() - 1) : numStr;
-                    
-                    msg.addr = static_cast<uint16_t>(std::stoul(addrStr, nullptr, 16));
-                    msg.start_cache_line = static_cast<uint8_t>(std::stoul(startStr, nullptr, 16));
-                    msg.num_of_cache_lines = static_cast<uint8_t>(std::stoul(numStr, nullptr, 16));
-
-                    break;
-                }
-                case MessageType::BROADCAST_INVALIDATE: {
-                    // Format: BROADCAST_INVALIDATE cache_line
-                    std::string cacheLineStr;
-                    iss >> std::hex >> cacheLineStr;
-                    
-                    if (cacheLineStr.find("0X") == 0) {
-                        cacheLineStr = cacheLineStr.substr(2);
-                    }
-                    
-                    msg.cache_line = static_cast<uint8_t>(std::stoul(cacheLineStr, nullptr, 16));
-                    break;
-                }
-                case MessageType::READ_MEM: {
-                    // Format: READ_MEM addr, size
-                    std::string addrStr, sizeStr;
-                    
-                    iss >> std::hex >> addrStr >> std::hex >> sizeStr;
-                    
-                    // Remove 0x if exists
-                    addrStr = (addrStr.size() >= 2 && addrStr.find("0X") == 0) ? addrStr.substr(2) : addrStr;
-                    sizeStr = (sizeStr.size() >= 2 && sizeStr.find("0X") == 0) ? sizeStr.substr(2) : sizeStr;
-                    
-                    msg.addr = static_cast<uint16_t>(std::stoul(addrStr, nullptr, 16));
-                    msg.size = static_cast<uint16_t>(std::stoul(sizeStr, nullptr, 16));
-                    break;
-                }
-                default:
-                    continue; // Unknown instruction type
-            }
-            
-            instructions.push(msg);
-        } catch (...) {
-            // Error processing the line - continue with the next
-            continue;
+        InstructionRecord record{};
+        bool valid = false;
+        if (equalsIgnoreCase(name, "WRITE_MEM")) {
+            // Format: WRITE_MEM addr, start_cache_line, num_of_cache_lines
+            record.type = static_cast<uint8_t>(MessageType::WRITE_MEM);
+            valid = parseHex(nextToken(line), record.addr) && parseHex(nextToken(line), record.operand) &&
+                    parseHex(nextToken(line), record.count);
+        } else if (equalsIgnoreCase(name, "READ_MEM")) {
+            // Format: READ_MEM addr, size
+            record.type = static_cast<uint8_t>(MessageType::READ_MEM);
+            valid = parseHex(nextToken(line), record.addr) && parseHex(nextToken(line), record.operand);
+        } else if (equalsIgnoreCase(name, "BROADCAST_INVALIDATE")) {
+            // Format: BROADCAST_INVALIDATE cache_line
+            record.type = static_cast<uint8_t>(MessageType::BROADCAST_INVALIDATE);
+            valid = parseHex(nextToken(line), record.operand);
+        }
+
+        // Unknown instruction or malformed operands - continue with the next line
+        if (valid) {
+            records.push_back(record);
         }
     }
 
+    if (!records.empty()) {
+        parsed.push_back(std::move(records));
+        addSegment(parsed.back().data(), parsed.back().size());
+    }
     return true;
 }
 
 void InstructionMemory::loadInstructions(const std::vector<Message>& msgs) {
+    std::vector<InstructionRecord> records;
+    records.reserve(msgs.size());
     for (const auto& msg : msgs) {
-        instructions.push(msg);
+        InstructionRecord record{};
+        record.type = static_cast<uint8_t>(msg.type);
+        record.addr = msg.addr;
+        switch (msg.type) {
+            case MessageType::READ_MEM: record.operand = msg.size; break;
+            case MessageType::WRITE_MEM:
+                record.operand = msg.start_cache_line;
+                record.count = msg.num_of_cache_lines;
+                break;
+            case MessageType::BROADCAST_INVALIDATE: record.operand = msg.cache_line; break;
+            default: break;
+        }
+        records.push_back(record);
+    }
+
+    if (!records.empty()) {
+        parsed.push_back(std::move(records));
+        addSegment(parsed.back().data(), parsed.back().size());
+    }
+}
+
+bool InstructionMemory::saveBinary(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    InstructionTraceHeader header{};
+    std::memcpy(header.magic, INSTRUCTION_TRACE_MAGIC, sizeof(header.magic));
+    header.version = INSTRUCTION_TRACE_VERSION;
+    header.record_bytes = sizeof(InstructionRecord);
+    header.records = remaining() - generated_left;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (size_t s = segment; s < segments.size(); s++) {
+        size_t first = s == segment ? position : 0;
+        file.write(reinterpret_cast<const char*>(segments[s].records + first),
+                   static_cast<std::streamsize>((segments[s].count - first) * sizeof(InstructionRecord)));
     }
+    return static_cast<bool>(file);
 }
 
 Message InstructionMemory::nextInstruction() {
-    Message msg = instructions.front();
-    instructions.pop();
+    Message msg = std::move(head);
+    if (segment < segments.size()) {
+        if (++position == segments[segment].count) {
+            segment++;
+            position = 0;
+        }
+    } else {
+        generated_left--;
+    }
+
+    if (segment < segments.size()) {
+        decodeHead(segments[segment].records[position]);
+    } else if (generated_left > 0) {
+        decodeHead(generator->next());
+    }
     return msg;
 }
 
+const Message& InstructionMemory::peekInstruction() const {
+    return head;
+}
+
 bool InstructionMemory::hasInstructions() const {
-    return !instructions.empty();
+    return segment < segments.size() || generated_left > 0;
+}
+
+size_t InstructionMemory::remaining() const {
+    size_t count = generated_left;
+    for (size_t s = segment; s < segments.size(); s++) {
+        count += segments[s].count - (s == segment ? position : 0);
+    }
+    return count;
 }
@@ -3,27 +3,133 @@
 
 #include <iostream>
 #include <fstream>
-#include <queue>
-#include <map>
-#include <sstream>
-#include <algorithm>
-#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "constants.hpp"
 #include "message.hpp"
 
+class TrafficGenerator;
+
+/**
+ * @brief One instruction of a compiled (binary) workload trace.
+ *
+ * Records are packed back to back after an InstructionTraceHeader, in host
+ * byte order.
+ */
+struct InstructionRecord {
+    uint32_t addr;
+    uint32_t operand;           // READ_MEM: size, WRITE_MEM: start_cache_line, BROADCAST_INVALIDATE: cache_line
+    uint32_t count;             // WRITE_MEM: num_of_cache_lines
+    uint8_t type;               // MessageType
+    uint8_t reserved[3];
+};
+
+/**
+ * @brief Header of a compiled workload trace.
+ */
+struct InstructionTraceHeader {
+    char magic[8];              // INSTRUCTION_TRACE_MAGIC
+    uint32_t version;           // INSTRUCTION_TRACE_VERSION
+    uint32_t record_bytes;      // sizeof(InstructionRecord)
+    uint64_t records;
+};
+
+static_assert(sizeof(InstructionRecord) == 16, "InstructionRecord is part of the file format");
+static_assert(sizeof(InstructionTraceHeader) == 24, "InstructionTraceHeader is part of the file format");
+
+/**
+ * @brief Read-only memory mapping of a whole file, unmapped on destruction.
+ */
+class MappedFile {
+private:
+    void* base = nullptr;
+    size_t length = 0;
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file.
+     *
+     * @return true if the file was mapped, false otherwise (missing or empty file).
+     */
+    bool open(const std::string& filename);
+
+    const char* data() const { return static_cast<const char*>(base); }
+    size_t size() const { return length; }
+};
+
 /**
  * @brief Class to manage instruction memory, loading instructions from a file.
  *
- * Stores instructions in a queue for sequential processing.
+ * Instructions are kept as packed InstructionRecords and turned into a
+ * Message only when they reach the front. A compiled trace is mapped and
+ * iterated in place (zero-copy, pages shared by every PE running the same
+ * workload); a text workload is parsed once into records. Each load appends
+ * its instructions after the ones already loaded. A TrafficGenerator can
+ * follow the loaded instructions, producing its records on demand.
  */
 class InstructionMemory {
+private:
+    struct Segment {
+        const InstructionRecord* records;
+        size_t count;
+    };
+
+    std::vector<Segment> segments;                          // Loaded instructions, in program order
+    std::vector<std::vector<InstructionRecord>> parsed;     // Storage of the text and vector loads
+    std::vector<std::unique_ptr<MappedFile>> mappings;      // Storage of the compiled traces
+    size_t segment = 0;                                     // Segment of the next instruction
+    size_t position = 0;                                    // Next instruction within the segment
+    std::unique_ptr<TrafficGenerator> generator;            // Source of the instructions after the segments
+    uint64_t generated_left = 0;                            // Instructions still to generate (head included)
+    Message head;                                           // Next instruction, decoded
+    size_t rejected = 0;                                    // Compiled records of an unknown type, skipped
+
+    /**
+     * @brief Appends a segment, decoding it if it holds the next instruction.
+     */
+    void addSegment(const InstructionRecord* records, size_t count);
+
+    /**
+     * @brief Decodes a record into head.
+     */
+    void decodeHead(const InstructionRecord& record);
+
+    /**
+     * @brief Maps a compiled trace and appends its records.
+     *
+     * @return false if the file is not a valid trace.
+     */
+    bool loadBinary(const std::string& filename);
+
+    /**
+     * @brief Parses a text workload and appends its records.
+     */
+    bool loadText(const std::string& filename);
+
 public:
-    std::queue<Message> instructions; // Queue of instructions to be executed
+    InstructionMemory();
+    ~InstructionMemory();
+
+    InstructionMemory(const InstructionMemory&) = delete;
+    InstructionMemory& operator=(const InstructionMemory&) = delete;
 
     /**
-     * @brief Loads instructions from a file into the instruction queue.
+     * @brief Loads instructions from a file after the ones already loaded.
      *
-     * Reads each line, parses it into an instruction, and adds it to the queue.
-     * Supports WRITE_MEM, READ_MEM, and BROADCAST_INVALIDATE instructions.
+     * Files starting with INSTRUCTION_TRACE_MAGIC are compiled traces and
+     * are mapped; records whose type is not an instruction are skipped and
+     * counted (getRejected). Otherwise each line is parsed as a text instruction
+     * (WRITE_MEM, READ_MEM or BROADCAST_INVALIDATE, case-insensitive, hex
+     * operands, "//" comments); malformed lines are skipped.
      *
      * @param filename The name of the file to load instructions from.
      * @return true if the file was loaded successfully, false otherwise.
@@ -31,26 +137,63 @@ public:
     bool loadFromFile(const std::string& filename);
 
     /**
-     * @brief Loads a vector of Message instructions into the instruction queue.
-     * 
-     * @param msgs Vector of Message structs to load into the queue.
+     * @brief Loads a vector of Message instructions after the ones already loaded.
+     *
+     * Only the fields of an instruction are kept (type and operands).
+     *
+     * @param msgs Vector of Message structs to load.
      */
     void loadInstructions(const std::vector<Message>& msgs);
 
     /**
-     * @brief Retrieves the next instruction from the queue.
+     * @brief Appends synthetic instructions after every loaded one.
+     *
+     * Files must be loaded before the generator is set.
+     *
+     * @param source Generator of the instructions.
+     * @param count Number of instructions to generate.
+     */
+    void setGenerator(std::unique_ptr<TrafficGenerator> source, uint64_t count);
+
+    /**
+     * @brief Writes the remaining loaded (not generated) instructions as a compiled trace.
+     *
+     * @param filename Output file.
+     * @return true if the file was written, false otherwise.
+     */
+    bool saveBinary(const std::string& filename) const;
+
+    /**
+     * @brief Retrieves the next instruction.
      *
-     * @return The next instruction in the queue.
-     * @note This method removes the instruction from the queue.
+     * @return The next instruction.
+     * @note This method removes the instruction from the memory.
      */
     Message nextInstruction();
 
     /**
-     * @brief Checks if there are more instructions in the queue.
+     * @brief Gets the next instruction without removing it.
+     *
+     * @return The next instruction (there must be one).
+     */
+    const Message& peekInstruction() const;
+
+    /**
+     * @brief Checks if there are more instructions.
      *
      * @return true if there are more instructions, false otherwise.
      */
     bool hasInstructions() const;
+
+    /**
+     * @brief Gets the number of instructions left.
+     */
+    size_t remaining() const;
+
+    /**
+     * @brief Gets the number of compiled records skipped for having an unknown type.
+     */
+    size_t getRejected() const { return rejected; }
 };
 
 #endif // INSTRUCTION_MEMORY_HPP
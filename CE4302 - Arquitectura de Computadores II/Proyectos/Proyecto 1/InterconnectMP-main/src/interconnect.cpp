@@ -3,9 +3,12 @@
 
 Logger interconnet_logger("../resources/logs/interconnect_log.txt", false);
 Logger interconnet_stats_logger("../resources/logs/interconnect_stats_log.txt", false);
+EventLog interconnect_events(interconnet_logger, "../resources/logs/interconnect_log.bin");
 
-Interconnect::Interconnect(SharedMemory& mem, bool use_qos) 
-    : memory(mem), use_qos_arbitration(use_qos), running(true) {}
+Interconnect::Interconnect(SharedMemory& mem, ArbitrationScheme arbitration, size_t queue_capacity) 
+    : memory(mem), queue_capacity(queue_capacity), scheme(arbitration), running(true) {
+    setWorkers(1, WORDS_PER_BLOCK * INTERCONNECT_SHARD_BLOCKS);
+}
 
 const InterconnectStats& Interconnect::getStats() {
     return stats;
@@ -13,134 +16,618 @@ const InterconnectStats& Interconnect::getStats() {
 
 void Interconnect::registerPE(ProcessingElement* pe) {
     pes.push_back(pe);
+    pe->setPayloadArena(&payload_arena);
+    pe->setBlockDirectory(use_directory ? &block_directory : nullptr);
+}
+
+void Interconnect::setArbitrationScheme(ArbitrationScheme arbitration) {
+    scheme = arbitration;
+    for (auto& worker : workers) {
+        configureArbiter(*worker);
+    }
 }
 
-void Interconnect::setArbitrationScheme(bool use_qos) {
-    use_qos_arbitration = use_qos;
+void Interconnect::configureArbiter(InterconnectWorker& worker) {
+    std::lock_guard<std::mutex> lock(worker.queue_mutex);
+    worker.arbiter = makeArbiter(scheme);
+    if (auto* qos = dynamic_cast<QoSArbiter*>(worker.arbiter.get())) {
+        qos->setAging(aging_cycles);
+    }
 }
 
 void Interconnect::setSteppingMode(bool enable) {
     stepping_mode = enable;
 }
 
-void Interconnect::enqueueMessage(const Message& msg) {
-    std::lock_guard<std::mutex> lock(queue_mutex);
-    if (use_qos_arbitration) {
-        qos_queue.push(msg);
+void Interconnect::setCycleCosts(const CycleCosts& cycle_costs) {
+    costs = cycle_costs;
+}
+
+void Interconnect::enableCoherence(CoherenceProtocol protocol) {
+    coherence_enabled = true;
+    coherence = protocol;
+}
+
+void Interconnect::enableDirectory(const SystemConfig& config) {
+    use_directory = true;
+    // Every PE starts with all of its cache blocks valid
+    block_directory.reset(config.cache_blocks, config.num_pes, true);
+    if (config.cache_mode == CacheMode::SET_ASSOCIATIVE) {
+        memory.enableDirectory(config.line_words, config.num_pes);
+    }
+}
+
+void Interconnect::setWorkers(size_t count, uint32_t shard_words) {
+    shard_bytes = std::max<uint32_t>(shard_words, 1) * 4;
+    workers.clear();
+    for (size_t i = 0; i < std::max<size_t>(count, 1); i++) {
+        workers.push_back(std::make_unique<InterconnectWorker>(queue_capacity));
+        workers.back()->id = static_cast<uint16_t>(i);
+        configureArbiter(*workers.back());
+    }
+}
+
+void Interconnect::setQoSAging(uint64_t cycles) {
+    aging_cycles = cycles;
+    for (auto& worker : workers) {
+        configureArbiter(*worker);
+    }
+}
+
+size_t Interconnect::getWorkers() const {
+    return workers.size();
+}
+
+void Interconnect::setTopology(const SystemConfig& config) {
+    network.configure(config.topology, config.num_pes, memory.getNumBanks());
+}
+
+const CycleCosts& Interconnect::getCycleCosts() const {
+    return costs;
+}
+
+uint64_t Interconnect::now() const {
+    uint64_t cycle = 0;
+    for (const auto& worker : workers) {
+        cycle = std::max(cycle, worker->clock.now());
+    }
+    return cycle;
+}
+
+void Interconnect::setHostDelay(uint64_t delay_us) {
+    host_delay_us = delay_us;
+}
+
+void Interconnect::setWaitPolicy(WaitPolicy policy, size_t spin_polls) {
+    wait_policy = policy;
+    spin_limit = spin_polls;
+}
+
+uint32_t Interconnect::bankOf(const Message& msg) const {
+    if (msg.type == MessageType::BROADCAST_INVALIDATE) {
+        return msg.cache_line % memory.getNumBanks();
+    }
+    return (msg.addr / 4) % memory.getNumBanks();
+}
+
+size_t Interconnect::workerOf(const Message& msg) const {
+    if (workers.size() == 1) return 0;
+    if (msg.type == MessageType::BROADCAST_INVALIDATE) {
+        return msg.cache_line % workers.size();
+    }
+    return (msg.addr / shard_bytes) % workers.size();
+}
+
+bool Interconnect::spansShards(const Message& msg) const {
+    uint64_t words = 0;
+    if (msg.type == MessageType::READ_MEM) {
+        words = msg.size;
+    } else if (msg.type == MessageType::WRITE_MEM) {
+        words = msg.data.size();
+    }
+    if (words == 0) return false;
+    uint64_t last_byte = msg.addr + words * 4 - 1;
+    return msg.addr / shard_bytes != last_byte / shard_bytes;
+}
+
+void Interconnect::enqueueMessage(Message&& msg) {
+    if (workers.size() > 1 && spansShards(msg)) {
+        splitRequest(std::move(msg));
+        return;
+    }
+    pushMessage(*workers[workerOf(msg)], std::move(msg));
+}
+
+void Interconnect::splitRequest(Message&& msg) {
+    bool is_write = msg.type == MessageType::WRITE_MEM;
+    uint32_t words = is_write ? msg.data.size() : msg.size;
+    std::span<const uint32_t> write_data = msg.data;
+
+    std::vector<Message> pieces;
+    for (uint32_t offset = 0; offset < words;) {
+        uint32_t addr = msg.addr + offset * 4;
+        uint32_t count = std::min(words - offset, (shard_bytes - addr % shard_bytes) / 4);
+
+        Message piece{
+            msg.type, msg.src, msg.dest, addr, count, msg.cache_line, msg.start_cache_line,
+            msg.num_of_cache_lines, msg.qos, msg.status, {}
+        };
+        if (is_write) {
+            piece.data.setArena(&payload_arena);
+            piece.data.append(write_data.subspan(offset, count));
+        }
+        piece.timestamp = msg.timestamp;
+        piece.req_id = msg.req_id;
+        piece.split = true;
+        pieces.push_back(std::move(piece));
+        offset += count;
+    }
+
+    // Registered before any piece can be serviced
+    {
+        std::lock_guard<std::mutex> lock(split_mutex);
+        SplitRequest& request = split_requests[Tracer::requestId(msg.src, msg.req_id)];
+        request.base_addr = msg.addr;
+        request.pending = pieces.size();
+        request.completion = 0;
+        if (!is_write) {
+            request.data.setArena(&payload_arena);
+            request.data.resize(words);
+        }
+    }
+    for (auto& piece : pieces) {
+        pushMessage(*workers[workerOf(piece)], std::move(piece));
+    }
+}
+
+bool Interconnect::joinSplit(InterconnectWorker& worker, const Message& piece, Message& resp) {
+    std::lock_guard<std::mutex> lock(split_mutex);
+    auto it = split_requests.find(Tracer::requestId(piece.src, piece.req_id));
+    if (it == split_requests.end()) {
+        throw std::logic_error("Serviced piece of an unknown split request");
+    }
+
+    SplitRequest& request = it->second;
+    if (piece.type == MessageType::READ_MEM) {
+        std::copy(resp.data.begin(), resp.data.end(), request.data.begin() + (piece.addr - request.base_addr) / 4);
+    }
+    request.completion = std::max(request.completion, resp.timestamp);
+    worker.stats.split_pieces++;
+    if (--request.pending > 0) return false;
+
+    if (piece.type == MessageType::READ_MEM) {
+        resp.data = std::move(request.data);
+    }
+    resp.timestamp = request.completion;
+    split_requests.erase(it);
+    worker.stats.split_requests++;
+    return true;
+}
+
+void Interconnect::pushMessage(InterconnectWorker& worker, Message&& msg) {
+    if (worker.arbiter) {
+        std::lock_guard<std::mutex> lock(worker.queue_mutex);
+        worker.arbiter->push(std::move(msg));
     } else {
-        fifo_queue.push(msg);
+        worker.fifo_queue.push(std::move(msg));
     }
+    notifyConsumer(worker);
 }
 
 void Interconnect::stopProcessing() {
     running = false;
+    for (auto& worker : workers) {
+        std::lock_guard<std::mutex> lock(worker->wake_mutex);
+        worker->wake_cv.notify_one();
+    }
 }
 
-void Interconnect::processMessages() {
-    interconnet_logger.log("Started processing messages");
+bool Interconnect::hasPendingMessages(InterconnectWorker& worker) {
+    if (worker.arbiter) {
+        std::lock_guard<std::mutex> lock(worker.queue_mutex);
+        return !worker.arbiter->empty();
+    }
+    return !worker.fifo_queue.empty();
+}
 
-    while (running) { 
-        size_t current_qsize = 0;
-        Message msg;
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex);
-            current_qsize = use_qos_arbitration ? qos_queue.size() : fifo_queue.size();
-
-            if (use_qos_arbitration) {
-                if (qos_queue.empty()) continue;
-                msg = qos_queue.top();
-                qos_queue.pop();
-            } else {
-                if (fifo_queue.empty()) continue;
-                msg = fifo_queue.front();
-                fifo_queue.pop();
+void Interconnect::notifyConsumer(InterconnectWorker& worker) {
+    // Pairs with the fence in waitForMessages: either this thread sees the
+    // parked flag or the worker sees the message before it sleeps
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.parked.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(worker.wake_mutex);
+        worker.wake_cv.notify_one();
+    }
+}
+
+void Interconnect::waitForMessages(InterconnectWorker& worker, size_t& idle_polls) {
+    switch (wait_policy) {
+        case WaitPolicy::SPIN:
+            return;
+        case WaitPolicy::SPIN_THEN_PARK:
+            if (++idle_polls < spin_limit) {
+                std::this_thread::yield();
+                return;
             }
+            break;
+        case WaitPolicy::BLOCK:
+            break;
+    }
+
+    std::unique_lock<std::mutex> lock(worker.wake_mutex);
+    worker.parked.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (running && !hasPendingMessages(worker)) {
+        worker.stats.parks++;
+        worker.wake_cv.wait(lock, [this, &worker] { return !running || hasPendingMessages(worker); });
+    }
+    worker.parked.store(false, std::memory_order_relaxed);
+    idle_polls = 0;
+}
+
+bool Interconnect::dequeueMessage(Message& msg, size_t& current_qsize) {
+    return dequeueMessage(*workers[0], msg, current_qsize);
+}
+
+bool Interconnect::dequeueMessage(InterconnectWorker& worker, Message& msg, size_t& current_qsize) {
+    if (worker.arbiter) {
+        std::lock_guard<std::mutex> lock(worker.queue_mutex);
+        current_qsize = worker.arbiter->size();
+
+        if (worker.arbiter->empty()) return false;
+        msg = worker.arbiter->pop(worker.clock.now());
+        return true;
+    }
+
+    current_qsize = worker.fifo_queue.size();
+    return worker.fifo_queue.tryPop(msg);
+}
+
+SnoopResult Interconnect::snoopOthers(const Message& msg, InterconnectStats& stats) {
+    bool invalidate = msg.type != MessageType::READ_SHARED;
+    Directory& directory = memory.getDirectory();
+    uint32_t line = use_directory ? memory.directoryLine(msg.addr) : 0;
+    SnoopResult result;
+
+    auto visit = [&](ProcessingElement* pe) {
+        SnoopResult snooped = pe->snoop(msg.addr, invalidate);
+        stats.snoop_lookups++;
+        result.keeps_copy |= snooped.keeps_copy;
+
+        if (snooped.keeps_copy || snooped.supplied) {
+            stats.snoop_hits++;
+        } else if (use_directory) {
+            directory.removeSharer(line, pe->getID()); // Clean line evicted silently
+            stats.stale_sharers++;
         }
+        if (!snooped.supplied) return;
 
-        stats.startProcessing();
-        // Small delay to allow other PEs to send messages. Otherwise the queue size will always be 1
-        std::this_thread::sleep_for(std::chrono::microseconds(10000)); 
-        //std::cout << "queue size: " << ((use_qos_arbitration) ? qos_queue.size() : fifo_queue.size()) << std::endl;
-        if (msg.addr % 4 != 0) {
-            throw std::runtime_error("Address not aligned to 4 bytes");
+        stats.cache_to_cache++;
+        if (coherence == CoherenceProtocol::MESI || snooped.from_writeback) {
+            memory.writeRange(msg.addr / 4, snooped.data);
+            stats.memory_flushes++;
+        } else {
+            stats.flushes_avoided++;
         }
+        result.supplied = true;
+        result.data = std::move(snooped.data);
+    };
 
-        interconnet_logger.log(messageToLog("Message received:", msg));
+    if (use_directory) {
+        directory.forEachSharer(line, msg.src, [&](uint16_t pe) { visit(pes[pe]); });
+    } else {
+        for (auto& pe : pes) {
+            if (pe->getID() == msg.src) continue; // Skip requester PE
+            visit(pe);
+        }
+    }
+    return result;
+}
 
-        // Process the message based on its type
-        switch (msg.type) {
-            case MessageType::READ_MEM: {
-                Message resp{
-                    MessageType::READ_RESP, 0xFF, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
-                };
+size_t Interconnect::snoopTargets(const Message& msg, InterconnectStats& stats) {
+    bool coherent = msg.type == MessageType::READ_SHARED || msg.type == MessageType::READ_EXCLUSIVE ||
+                    msg.type == MessageType::UPGRADE;
+    if (msg.type != MessageType::BROADCAST_INVALIDATE && !coherent) return 0;
+    if (!use_directory) return pes.size() - 1;
 
-                uint32_t value;
-                uint16_t pos = msg.addr / 4;
-                for (uint16_t i = 0; i < msg.size; i++) {
-                    value = memory.readByPosition(pos);
-                    resp.data.push_back(value);
-                    pos++;
+    size_t targets = msg.type == MessageType::BROADCAST_INVALIDATE ?
+        block_directory.countSharers(msg.cache_line, msg.src) :
+        memory.getDirectory().countSharers(memory.directoryLine(msg.addr), msg.src);
+
+    stats.directory_lookups++;
+    stats.directed_messages += targets;
+    stats.broadcast_messages += pes.size() - 1;
+    return targets;
+}
+
+bool Interconnect::handleMessage(const Message& msg, size_t current_qsize, Message& resp) {
+    return serviceMessage(*workers[0], msg, current_qsize, resp);
+}
+
+bool Interconnect::serviceMessage(InterconnectWorker& worker, const Message& msg, size_t current_qsize,
+                                  Message& resp) {
+    InterconnectStats& stats = worker.stats;
+    stats.startProcessing();
+    // Optional real delay to let other PEs fill the queue when measuring wall-clock behavior
+    if (host_delay_us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(host_delay_us));
+    }
+    if (msg.addr % 4 != 0) {
+        throw std::runtime_error("Address not aligned to 4 bytes");
+    }
+
+    LOG_AT(LogLevel::TRACE, LogCategory::INTERCONNECT, interconnect_events.message(EventKind::RECEIVED, msg));
+
+    // Charge the request hops, arbitration, service, response hops and delivery on the virtual clock
+    size_t invalidated_pes = snoopTargets(msg, stats);
+    uint64_t service_cycles = costs.arbitration + costs.serviceCycles(msg, invalidated_pes);
+    uint64_t arrival_cycle = msg.timestamp;
+    uint32_t bank_router = 0;
+    if (network.enabled()) {
+        bank_router = network.bankRouter(bankOf(msg));
+        arrival_cycle = network.traverse(msg.src, bank_router, msg.timestamp, Network::flits(msg.data.size()),
+                                         costs.hop, costs.flit);
+    }
+    worker.clock.advanceTo(arrival_cycle);
+    uint64_t service_start = worker.clock.now();
+    stats.recordWait(msg.qos, service_start - msg.timestamp);
+    uint64_t service_end = worker.clock.advance(service_cycles);
+    uint64_t completion_cycle = service_end;
+    if (network.enabled()) {
+        // Reads return their words; every other response is a single header flit
+        bool returns_data = msg.type == MessageType::READ_MEM || msg.type == MessageType::READ_SHARED ||
+                            msg.type == MessageType::READ_EXCLUSIVE;
+        completion_cycle = network.traverse(bank_router, msg.src, completion_cycle,
+                                            Network::flits(returns_data ? msg.size : 0), costs.hop, costs.flit);
+    }
+    completion_cycle += costs.response;
+    stats.recordCycles(msg.src, msg.timestamp, service_cycles, completion_cycle);
+    if (tracer.sampled(msg.req_id)) {
+        uint64_t request = Tracer::requestId(msg.src, msg.req_id);
+        tracer.record({request, msg.timestamp, arrival_cycle, TraceStage::SEND, msg.type, worker.id});
+        tracer.record({request, arrival_cycle, service_start, TraceStage::QUEUE, msg.type, worker.id});
+        tracer.record({request, service_start, service_end, TraceStage::SERVICE, msg.type, worker.id});
+        tracer.record({request, service_end, completion_cycle, TraceStage::RESPONSE, msg.type, worker.id});
+    }
+
+    bool responded = true;
+
+    // Process the message based on its type
+    switch (msg.type) {
+        case MessageType::READ_MEM: {
+            resp = Message{
+                MessageType::READ_RESP, INTERCONNECT_ID, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
+            };
+
+            resp.data.setArena(&payload_arena);
+            resp.data.resize(msg.size);
+            memory.readRange(msg.addr / 4, resp.data);
+            resp.qos = msg.qos;
+            resp.status = 0x1;
+            resp.timestamp = completion_cycle;
+            
+            stats.read_operations++;
+            break;
+        }
+        case MessageType::WRITE_MEM: {
+            resp = Message{
+                MessageType::WRITE_RESP, INTERCONNECT_ID, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
+            };
+
+            memory.writeRange(msg.addr / 4, msg.data);
+            resp.qos = msg.qos;
+            resp.status = 0x1;
+            resp.timestamp = completion_cycle;
+
+            stats.write_operations++;
+            break;
+        }
+        case MessageType::BROADCAST_INVALIDATE: {
+            resp = Message{
+                MessageType::INV_COMPLETE, INTERCONNECT_ID, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
+            };
+
+            if (use_directory) {
+                // Only the PEs invalidated here leave the list; the bit goes first so a PE
+                // that registers again while its block is invalidated stays listed
+                block_directory.forEachSharer(msg.cache_line, msg.src, [&](uint16_t pe) {
+                    block_directory.removeSharer(msg.cache_line, pe);
+                    pes[pe]->invalidateCacheBlock(msg.cache_line);
+                });
+            } else {
+                for (auto& pe : pes) {
+                    if (pe->getID() == msg.src) continue; // Skip sender PE
+                    pe->invalidateCacheBlock(msg.cache_line);
                 }
-                resp.qos = msg.qos;
-                resp.status = 0x1;
-                
-                stats.read_operations++;
-                interconnet_logger.log(messageToLog("Message sent:", resp));
-                pes[msg.src]->receiveMessage(resp); 
-                break;
             }
-            case MessageType::WRITE_MEM: {
-                Message resp{
-                    MessageType::WRITE_RESP, 0xFF, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
-                };
+            resp.cache_line = msg.cache_line;
+            resp.qos = msg.qos;
+            resp.status = 0x1;
+            resp.timestamp = completion_cycle;
+            
+            stats.invalidations++;
+            break;
+        }
+        case MessageType::UPGRADE:
+        case MessageType::READ_SHARED:
+        case MessageType::READ_EXCLUSIVE: {
+            // An upgrade from a PE that lost its copy meanwhile needs the data too
+            bool refill = msg.type == MessageType::UPGRADE && !pes[msg.src]->holdsLine(msg.addr);
+            SnoopResult snooped = snoopOthers(msg, stats);
 
-                uint16_t pos = msg.addr / 4;
-                for (uint32_t value : msg.data) {
-                    memory.writeByPosition(pos, value);
-                    pos++;
+            if (msg.type == MessageType::UPGRADE && !refill) {
+                resp = Message{
+                    MessageType::INV_COMPLETE, INTERCONNECT_ID, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
+                };
+                stats.upgrades++;
+            } else {
+                resp = Message{
+                    MessageType::READ_RESP, INTERCONNECT_ID, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
+                };
+                if (snooped.supplied) {
+                    resp.data = std::move(snooped.data);
+                } else {
+                    resp.data.setArena(&payload_arena);
+                    resp.data.resize(msg.size);
+                    memory.readRange(msg.addr / 4, resp.data);
                 }
-                resp.qos = msg.qos;
-                resp.status = 0x1;
+                resp.shared = snooped.keeps_copy;
 
-                stats.write_operations++;
-                interconnet_logger.log(messageToLog("Message sent:", resp));
-                pes[msg.src]->receiveMessage(resp); 
-                break;
+                if (msg.type == MessageType::UPGRADE) {
+                    stats.upgrades++;
+                    stats.upgrade_refills++;
+                } else if (msg.type == MessageType::READ_SHARED) {
+                    stats.read_shared++;
+                } else {
+                    stats.read_exclusive++;
+                }
             }
-            case MessageType::BROADCAST_INVALIDATE: {
-                Message resp{
-                    MessageType::INV_COMPLETE, 0xFF, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
-                };
+            resp.addr = msg.addr;
+            resp.qos = msg.qos;
+            resp.status = 0x1;
+            resp.timestamp = completion_cycle;
 
-                for (auto& pe : pes) {
-                    if (pe->getID() == msg.src) continue; // Skip sender PE
-                    pe->invalidateCacheBlock(msg.cache_line);
+            pes[msg.src]->completeFill(resp);
+            if (use_directory) {
+                uint32_t line = memory.directoryLine(msg.addr);
+                if (msg.type != MessageType::READ_SHARED) {
+                    memory.getDirectory().keepOnly(line, msg.src);
                 }
-                resp.cache_line = msg.cache_line;
-                resp.qos = msg.qos;
-                resp.status = 0x1;
-                
-                stats.invalidations++;
-                interconnet_logger.log(messageToLog("Message sent:", resp));
-                pes[msg.src]->receiveMessage(resp); 
-                break;
+                memory.getDirectory().addSharer(line, msg.src);
+            }
+            break;
+        }
+        case MessageType::WRITEBACK: {
+            resp = Message{
+                MessageType::WRITE_RESP, INTERCONNECT_ID, msg.src, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x0, {}
+            };
+
+            // A snoop may already have flushed newer data for this line
+            if (pes[msg.src]->retireWriteback(msg.addr)) {
+                memory.writeRange(msg.addr / 4, msg.data);
+            } else {
+                stats.dropped_writebacks++;
+            }
+            if (use_directory) {
+                memory.getDirectory().removeSharer(memory.directoryLine(msg.addr), msg.src);
             }
-            default:
-                // Handles unknown or unimplemented messages
-                std::cerr << "Unknown type message received: " << static_cast<int>(msg.type) << std::endl;
-                break;
+            resp.addr = msg.addr;
+            resp.qos = msg.qos;
+            resp.status = 0x1;
+            resp.timestamp = completion_cycle;
+
+            stats.writebacks++;
+            break;
+        }
+        default:
+            // Handles unknown or unimplemented messages
+            std::cerr << "Unknown type message received: " << static_cast<int>(msg.type) << std::endl;
+            responded = false;
+            break;
+    }
+
+    if (responded) {
+        resp.req_id = msg.req_id;
+        LOG_AT(LogLevel::TRACE, LogCategory::INTERCONNECT, interconnect_events.message(EventKind::SENT, resp));
+    }
+    stats.total_messages_processed++;
+    stats.endProcessing(current_qsize);
+
+    return responded;
+}
+
+void Interconnect::waitForStep() {
+    if (stepping_mode) {
+        std::cout << "[Stepping mode] Press Enter to continue...\n";
+        std::string input;
+        std::getline(std::cin, input);
+    }
+}
+
+void Interconnect::runWorker(InterconnectWorker& worker) {
+    auto cpu_start = threadCpuTime();
+    size_t idle_polls = 0;
+
+    while (running) { 
+        size_t current_qsize = 0;
+        Message msg;
+
+        if (!dequeueMessage(worker, msg, current_qsize)) {
+            waitForMessages(worker, idle_polls);
+            continue;
         }
-        stats.total_messages_processed++;
-        stats.endProcessing(current_qsize);
+        idle_polls = 0;
 
-        if (stepping_mode) {
-            std::cout << "[Stepping mode] Press Enter to continue...\n";
-            std::string input;
-            std::getline(std::cin, input);
+        Message resp;
+        if (serviceMessage(worker, msg, current_qsize, resp) && (!msg.split || joinSplit(worker, msg, resp))) {
+            pes[msg.src]->receiveMessage(std::move(resp));
         }
+
+        waitForStep();
+    }
+
+    worker.stats.cpu_time = threadCpuTime() - cpu_start;
+}
+
+void Interconnect::processMessages() {
+    LOG_AT(LogLevel::INFO, LogCategory::INTERCONNECT, interconnect_events.note("Started processing messages"));
+
+    auto wall_start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> worker_threads;
+    for (size_t i = 1; i < workers.size(); i++) {
+        worker_threads.emplace_back([this, i]() { runWorker(*workers[i]); });
+    }
+    runWorker(*workers[0]);
+    for (auto& thread : worker_threads) {
+        thread.join();
     }
 
-    interconnet_logger.log("Stopped processing messages");
-    std::string arbitration = use_qos_arbitration ? "QoS" : "FIFO";
+    stats.wall_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - wall_start);
+    stats.wait_policy = waitPolicyName(wait_policy);
+
+    LOG_AT(LogLevel::INFO, LogCategory::INTERCONNECT, interconnect_events.note("Stopped processing messages"));
+    saveStats();
+}
+
+void Interconnect::saveStats() {
+    for (const auto& worker : workers) {
+        if (auto* qos = dynamic_cast<const QoSArbiter*>(worker->arbiter.get())) {
+            worker->stats.aged_picks = qos->getAgedPicks();
+        }
+        stats.merge(worker->stats);
+    }
+    stats.aging_cycles = scheme == ArbitrationScheme::QOS ? aging_cycles : 0;
+    stats.workers = workers.size();
+    stats.simulated_cycles = now();
+    stats.memory_banks = memory.getNumBanks();
+    stats.bank_accesses = memory.getBankAccesses();
+    stats.bank_conflicts = memory.getBankConflicts();
+    stats.payload_blocks = payload_arena.getBlocksServed();
+    stats.payload_recycled = payload_arena.getBlocksRecycled();
+    stats.payload_allocations = payload_arena.getSystemAllocations() + Payload::getHeapAllocations();
+    stats.payload_copies = Payload::getCopies();
+    stats.payload_copied_bytes = Payload::getCopiedBytes();
+    stats.coherence_enabled = coherence_enabled;
+    stats.coherence_protocol = coherenceProtocolName(coherence);
+    stats.directory_enabled = use_directory;
+    stats.directory_bytes = block_directory.bytes() + memory.getDirectory().bytes();
+    if (const Topology* topology = network.getTopology()) {
+        stats.topology = topology->name();
+        stats.network_traversals = network.getTraversals();
+        stats.network_hops = network.getTotalHops();
+        stats.link_contention_cycles = network.getContentionCycles();
+        stats.link_busy_cycles = network.getLinkBusyCycles();
+        stats.link_names.clear();
+        for (uint32_t link = 0; link < topology->numLinks(); link++) {
+            stats.link_names.push_back(topology->linkName(link));
+        }
+    }
+    stats.silent_upgrades = 0;
+    for (auto& pe : pes) {
+        stats.silent_upgrades += pe->getStats().silent_upgrades;
+    }
+    std::string arbitration = arbitrationSchemeLabel(scheme);
     interconnet_stats_logger.log(stats.getSummary(arbitration));
 }
@@ -1,19 +1,73 @@
 #ifndef INTERCONNECT_HPP
 #define INTERCONNECT_HPP
 
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <queue>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <memory>
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <string>
+#include <time.h>
 #include <unistd.h>
 #include <condition_variable>
 #include "logger.hpp"
+#include "event_log.hpp"
 #include "message.hpp"
+#include "mpsc_ring_buffer.hpp"
+#include "qos_arbiter.hpp"
 #include "shared_memory.hpp"
+#include "directory.hpp"
+#include "histogram.hpp"
+#include "sim_clock.hpp"
+#include "system_config.hpp"
+#include "topology.hpp"
+#include "tracer.hpp"
 
-// Forward declaration
+// Forward declarations
 class ProcessingElement;
+struct SnoopResult;
+
+/**
+ * @brief How the interconnect thread waits while its queues are empty.
+ */
+enum class WaitPolicy {
+    SPIN,           // Poll continuously (burns a full core)
+    BLOCK,          // Park on a condition variable until a message arrives
+    SPIN_THEN_PARK  // Poll a bounded number of times, then park
+};
+
+/**
+ * @brief Converts a wait policy to the name used on the command line.
+ *
+ * @param policy The wait policy.
+ * @return "spin", "block" or "hybrid".
+ */
+inline std::string waitPolicyName(WaitPolicy policy) {
+    switch (policy) {
+        case WaitPolicy::SPIN: return "spin";
+        case WaitPolicy::BLOCK: return "block";
+        case WaitPolicy::SPIN_THEN_PARK: return "hybrid";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Reads the CPU time consumed so far by the calling thread.
+ *
+ * @return CPU time of the calling thread in microseconds.
+ */
+inline std::chrono::microseconds threadCpuTime() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + 
+           std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(ts.tv_nsec));
+}
 
 /**
  * @brief Structure to save stats of the interconnect
@@ -26,7 +80,7 @@ struct InterconnectStats {
     size_t invalidations = 0;
 
     // Processing times
-    std::vector<double> processing_times;
+    Histogram processing_times;                     // Host time per message (μs)
     std::chrono::microseconds total_processing_time{0};
     std::chrono::time_point<std::chrono::high_resolution_clock> last_processing_start;
 
@@ -35,6 +89,76 @@ struct InterconnectStats {
     size_t total_qobservations = 0;
     double avg_qsize = 0;
 
+    // Simulated time (cycles)
+    uint64_t simulated_cycles = 0;                  // Virtual clock when processing stopped
+    uint64_t busy_cycles = 0;                       // Cycles spent arbitrating and servicing
+    Histogram latency_cycles;                       // Issue-to-completion latency of each message
+
+    // Service received by each source PE
+    std::vector<size_t> pe_messages;                // Messages serviced
+    std::vector<uint64_t> pe_last_completion;       // Completion cycle of the last one
+
+    // Interconnect thread usage
+    std::string wait_policy = "block";
+    size_t parks = 0;                               // Times the thread went to sleep
+    std::chrono::microseconds cpu_time{0};          // CPU time of the interconnect thread
+    std::chrono::microseconds wall_time{0};         // Lifetime of processMessages
+
+    // Shared memory banking
+    uint32_t memory_banks = 1;
+    uint64_t bank_accesses = 0;                     // Bank lock acquisitions
+    uint64_t bank_conflicts = 0;                    // Acquisitions that found the bank busy
+
+    // Message payload storage
+    uint64_t payload_blocks = 0;                    // Arena blocks handed out
+    uint64_t payload_recycled = 0;                  // Arena blocks reused from a free list
+    uint64_t payload_allocations = 0;               // General-purpose allocator calls
+    uint64_t payload_copies = 0;                    // Payload copies anywhere in the system
+    uint64_t payload_copied_bytes = 0;
+
+    // Cache coherence (set-associative PE caches)
+    bool coherence_enabled = false;
+    std::string coherence_protocol = "MESI";
+    size_t read_shared = 0;
+    size_t read_exclusive = 0;
+    size_t upgrades = 0;
+    size_t writebacks = 0;
+    size_t snoop_lookups = 0;                       // PE caches looked up by coherent requests
+    size_t snoop_hits = 0;                          // Lookups that found the line
+    size_t cache_to_cache = 0;                      // Dirty lines passed from one cache to another
+    size_t memory_flushes = 0;                      // Dirty lines written to memory by a snoop
+    size_t flushes_avoided = 0;                     // Dirty lines kept OWNED instead of written (MOESI)
+    size_t upgrade_refills = 0;                     // UPGRADEs answered with data (line lost meanwhile)
+    size_t dropped_writebacks = 0;                  // WRITEBACKs already flushed by a snoop
+    size_t silent_upgrades = 0;                     // Stores to EXCLUSIVE lines, over all PEs
+
+    // Sharer directory
+    bool directory_enabled = false;
+    size_t directory_lookups = 0;                   // Invalidations and snoops resolved through a directory
+    size_t directed_messages = 0;                   // PEs reached (listed sharers)
+    size_t broadcast_messages = 0;                  // PEs a broadcast would have reached
+    size_t stale_sharers = 0;                       // Listed PEs that no longer held the line
+    size_t directory_bytes = 0;
+
+    // QoS arbitration
+    uint64_t aging_cycles = 0;                      // Wait that raises a message one level (0: off)
+    uint64_t aged_picks = 0;                        // Messages picked ahead of a higher QoS by aging
+    std::map<uint8_t, Histogram> qos_wait_cycles;   // Issue-to-service wait of each message, per QoS
+
+    // On-chip network
+    std::string topology = "ideal";
+    uint64_t network_traversals = 0;                // Requests and responses routed
+    uint64_t network_hops = 0;                      // Links crossed by all of them
+    uint64_t link_contention_cycles = 0;            // Cycles spent waiting for busy links
+    std::vector<std::string> link_names;
+    std::vector<uint64_t> link_busy_cycles;         // Cycles each link was occupied
+
+    // Interconnect workers
+    size_t workers = 1;
+    std::vector<size_t> worker_messages;            // Messages serviced by each worker
+    size_t split_requests = 0;                      // Requests serviced in pieces by several workers
+    size_t split_pieces = 0;                        // Pieces of those requests (counted as messages)
+
     // Utility methods
     void startProcessing() {
         last_processing_start = std::chrono::high_resolution_clock::now();
@@ -45,7 +169,7 @@ struct InterconnectStats {
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
             end - last_processing_start);
         
-        processing_times.push_back(duration.count());
+        processing_times.record(static_cast<uint64_t>(duration.count()));
         total_processing_time += duration;
 
         max_qsize = std::max(max_qsize, current_qsize);
@@ -54,13 +178,128 @@ struct InterconnectStats {
         total_qobservations++;
     }
 
+    void recordWait(uint8_t qos, uint64_t cycles) {
+        qos_wait_cycles[qos].record(cycles);
+    }
+
+    void recordCycles(uint16_t src, uint64_t issue_cycle, uint64_t service_cycles, uint64_t completion_cycle) {
+        uint64_t latency = completion_cycle - std::min(issue_cycle, completion_cycle);
+        busy_cycles += service_cycles;
+        latency_cycles.record(latency);
+
+        if (src >= pe_messages.size()) {
+            pe_messages.resize(static_cast<size_t>(src) + 1, 0);
+            pe_last_completion.resize(static_cast<size_t>(src) + 1, 0);
+        }
+        pe_messages[src]++;
+        pe_last_completion[src] = std::max(pe_last_completion[src], completion_cycle);
+    }
+
+    /**
+     * @brief Gets Jain's fairness index of the service rates of the PEs.
+     *
+     * The rate of a PE is its serviced messages over the cycle its last one
+     * completed. 1.0 means every PE was serviced at the same rate, 1/n that
+     * a single PE got all the service.
+     */
+    double fairnessIndex() const {
+        double sum = 0.0, sum_squares = 0.0;
+        size_t flows = 0;
+        for (size_t pe = 0; pe < pe_messages.size(); pe++) {
+            if (pe_messages[pe] == 0 || pe_last_completion[pe] == 0) continue;
+            double rate = static_cast<double>(pe_messages[pe]) / pe_last_completion[pe];
+            sum += rate;
+            sum_squares += rate * rate;
+            flows++;
+        }
+        return sum_squares > 0.0 ? sum * sum / (flows * sum_squares) : 1.0;
+    }
+
+    /**
+     * @brief Adds the counters of one worker to these stats.
+     */
+    void merge(const InterconnectStats& worker) {
+        total_messages_processed += worker.total_messages_processed;
+        read_operations += worker.read_operations;
+        write_operations += worker.write_operations;
+        invalidations += worker.invalidations;
+
+        processing_times.merge(worker.processing_times);
+        total_processing_time += worker.total_processing_time;
+
+        max_qsize = std::max(max_qsize, worker.max_qsize);
+        size_t observations = total_qobservations + worker.total_qobservations;
+        if (observations > 0) {
+            avg_qsize = (avg_qsize * total_qobservations + worker.avg_qsize * worker.total_qobservations) /
+                        observations;
+        }
+        total_qobservations = observations;
+
+        busy_cycles += worker.busy_cycles;
+        latency_cycles.merge(worker.latency_cycles);
+        if (worker.pe_messages.size() > pe_messages.size()) {
+            pe_messages.resize(worker.pe_messages.size(), 0);
+            pe_last_completion.resize(worker.pe_messages.size(), 0);
+        }
+        for (size_t pe = 0; pe < worker.pe_messages.size(); pe++) {
+            pe_messages[pe] += worker.pe_messages[pe];
+            pe_last_completion[pe] = std::max(pe_last_completion[pe], worker.pe_last_completion[pe]);
+        }
+
+        parks += worker.parks;
+        cpu_time += worker.cpu_time;
+
+        read_shared += worker.read_shared;
+        read_exclusive += worker.read_exclusive;
+        upgrades += worker.upgrades;
+        writebacks += worker.writebacks;
+        snoop_lookups += worker.snoop_lookups;
+        snoop_hits += worker.snoop_hits;
+        cache_to_cache += worker.cache_to_cache;
+        memory_flushes += worker.memory_flushes;
+        flushes_avoided += worker.flushes_avoided;
+        upgrade_refills += worker.upgrade_refills;
+        dropped_writebacks += worker.dropped_writebacks;
+
+        aged_picks += worker.aged_picks;
+        for (const auto& [qos, waits] : worker.qos_wait_cycles) {
+            qos_wait_cycles[qos].merge(waits);
+        }
+
+        directory_lookups += worker.directory_lookups;
+        directed_messages += worker.directed_messages;
+        broadcast_messages += worker.broadcast_messages;
+        stale_sharers += worker.stale_sharers;
+
+        split_requests += worker.split_requests;
+        split_pieces += worker.split_pieces;
+        worker_messages.push_back(worker.total_messages_processed);
+    }
+
     std::string getSummary(std::string& arbitration) const {
         std::stringstream ss;
         ss << std::fixed << std::setprecision(2);
         
-        double avg_process_time = processing_times.empty() ? 0.0 :
-            std::accumulate(processing_times.begin(), processing_times.end(), 0.0) 
-            / processing_times.size();
+        double busy_percent = simulated_cycles > 0 ?
+            100.0 * busy_cycles / simulated_cycles : 0.0;
+
+        // Throughput over the makespan: the cycle the last response reached its PE
+        uint64_t makespan = pe_last_completion.empty() ? 0 :
+            *std::max_element(pe_last_completion.begin(), pe_last_completion.end());
+        double messages_per_kcycle = makespan > 0 ? 1000.0 * total_messages_processed / makespan : 0.0;
+
+        double cpu_usage = wall_time.count() > 0 ?
+            100.0 * cpu_time.count() / wall_time.count() : 0.0;
+        double messages_per_second = wall_time.count() > 0 ?
+            1e6 * total_messages_processed / wall_time.count() : 0.0;
+
+        // Every processed request produces one response
+        double allocs_per_message = total_messages_processed == 0 ? 0.0 :
+            static_cast<double>(payload_allocations) / (2 * total_messages_processed);
+        double copies_per_round_trip = total_messages_processed == 0 ? 0.0 :
+            static_cast<double>(payload_copies) / total_messages_processed;
+        double copied_bytes_per_round_trip = total_messages_processed == 0 ? 0.0 :
+            static_cast<double>(payload_copied_bytes) / total_messages_processed;
 
         ss << "\n======== Interconnect Stats ========\n"
            << "Arbitration:         " << arbitration << "\n\n"
@@ -69,61 +308,353 @@ struct InterconnectStats {
            << "  WRITE_MEM:         " << write_operations << "\n"
            << "  INVALIDATIONS:     " << invalidations << "\n\n"
            << "Processing Times (μs):\n"
-           << "  Average:           " << avg_process_time << "\n"
+           << "  Average:           " << processing_times.mean() << "\n"
+           << "  p50:               " << processing_times.percentile(0.50) << "\n"
+           << "  p90:               " << processing_times.percentile(0.90) << "\n"
+           << "  p99:               " << processing_times.percentile(0.99) << "\n"
+           << "  p99.9:             " << processing_times.percentile(0.999) << "\n"
+           << "  Max:               " << processing_times.max() << "\n"
            << "  Total:             " << total_processing_time.count() << "\n\n"
            << "Queue Statistics:\n"
            << "  Max Size:          " << max_qsize << "\n"
-           << "  Average Size:      " << avg_qsize << "\n"
-           << "====================================\n";
+           << "  Average Size:      " << avg_qsize << "\n\n"
+           << "Simulated Time (cycles):\n"
+           << "  Clock:             " << simulated_cycles << "\n"
+           << "  Busy:              " << busy_cycles << " (" << busy_percent << "%)\n"
+           << "  Mean Latency:      " << latency_cycles.mean() << "\n"
+           << "  Latency p50:       " << latency_cycles.percentile(0.50) << "\n"
+           << "  Latency p90:       " << latency_cycles.percentile(0.90) << "\n"
+           << "  Latency p99:       " << latency_cycles.percentile(0.99) << "\n"
+           << "  Latency p99.9:     " << latency_cycles.percentile(0.999) << "\n"
+           << "  Max Latency:       " << latency_cycles.max() << "\n\n"
+           << "Arbitration Fairness:\n"
+           << "  Jain Index:        " << std::setprecision(4) << fairnessIndex() << std::setprecision(2) << "\n"
+           << "  Throughput:        " << messages_per_kcycle << " msgs/kcycle\n\n"
+           << "Interconnect Threads:\n"
+           << "  Workers:           " << workers << "\n"
+           << "  Wait Policy:       " << wait_policy << "\n"
+           << "  Parks:             " << parks << "\n"
+           << "  CPU Time (μs):     " << cpu_time.count() << "\n"
+           << "  Wall Time (μs):    " << wall_time.count() << "\n"
+           << "  CPU Usage:         " << cpu_usage << "%\n"
+           << "  Messages/s:        " << messages_per_second << "\n";
+        if (workers > 1) {
+            ss << "  Split Requests:    " << split_requests << " (" << split_pieces << " pieces)\n";
+            for (size_t w = 0; w < worker_messages.size(); w++) {
+                ss << "  Worker " << w << " Messages: " << worker_messages[w] << "\n";
+            }
+        }
+        ss << "\n"
+           << "Memory Banks:\n"
+           << "  Banks:             " << memory_banks << "\n"
+           << "  Bank Accesses:     " << bank_accesses << "\n"
+           << "  Bank Conflicts:    " << bank_conflicts << "\n\n"
+           << "Message Payloads:\n"
+           << "  Arena Blocks:      " << payload_blocks << "\n"
+           << "  Recycled Blocks:   " << payload_recycled << "\n"
+           << "  Heap Allocations:  " << payload_allocations << "\n"
+           << "  Allocs/Message:    " << std::setprecision(4) << allocs_per_message << "\n"
+           << "  Payload Copies:    " << payload_copies << "\n"
+           << "  Copied Bytes:      " << payload_copied_bytes << "\n"
+           << "  Copies/Round Trip: " << copies_per_round_trip << "\n"
+           << "  Bytes/Round Trip:  " << copied_bytes_per_round_trip << "\n";
+
+        if (coherence_enabled) {
+            ss << "\nCoherence (" << coherence_protocol << "):\n"
+               << "  READ_SHARED:       " << read_shared << "\n"
+               << "  READ_EXCLUSIVE:    " << read_exclusive << "\n"
+               << "  UPGRADE:           " << upgrades << "\n"
+               << "  WRITEBACK:         " << writebacks << "\n"
+               << "  Snoop Lookups:     " << snoop_lookups << "\n"
+               << "  Snoop Hits:        " << snoop_hits << "\n"
+               << "  Cache-to-Cache:    " << cache_to_cache << "\n"
+               << "  Memory Flushes:    " << memory_flushes << "\n"
+               << "  Upgrade Refills:   " << upgrade_refills << "\n"
+               << "  Dropped Writebacks: " << dropped_writebacks << "\n"
+               << "  Bus transactions saved:\n"
+               << "    UPGRADEs (E state):      " << silent_upgrades << "\n"
+               << "    Memory writes (O state): " << flushes_avoided << "\n";
+        }
+        if (directory_enabled) {
+            size_t avoided = broadcast_messages - directed_messages;
+            double avoided_percent = broadcast_messages > 0 ? 100.0 * avoided / broadcast_messages : 0.0;
+            ss << std::setprecision(2)
+               << "\nSharer Directory (bit-vector):\n"
+               << "  Lookups:           " << directory_lookups << "\n"
+               << "  Targeted PEs:      " << directed_messages << "\n"
+               << "  Broadcast PEs:     " << broadcast_messages << "\n"
+               << "  Avoided:           " << avoided << " (" << avoided_percent << "%)\n"
+               << "  Stale Sharers:     " << stale_sharers << "\n"
+               << "  Directory Bytes:   " << directory_bytes << "\n";
+        }
+        if (!qos_wait_cycles.empty()) {
+            ss << "\nWait by QoS (cycles, issue to service):\n";
+            if (aging_cycles > 0) {
+                ss << "  Aging:             1 level per " << aging_cycles << " cycles\n"
+                   << "  Aged Picks:        " << aged_picks << "\n";
+            }
+            ss << "  QoS    msgs      p50      p90      p99    p99.9      max\n";
+            for (const auto& [qos, waits] : qos_wait_cycles) {
+                ss << "  0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (int)qos
+                   << std::dec << std::setfill(' ')
+                   << std::setw(8) << waits.count()
+                   << std::setw(9) << waits.percentile(0.50)
+                   << std::setw(9) << waits.percentile(0.90)
+                   << std::setw(9) << waits.percentile(0.99)
+                   << std::setw(9) << waits.percentile(0.999)
+                   << std::setw(9) << waits.max() << "\n";
+            }
+        }
+        if (!link_busy_cycles.empty()) {
+            double mean_hops = network_traversals > 0 ?
+                static_cast<double>(network_hops) / network_traversals : 0.0;
+            auto utilization = [this](double busy) {
+                return simulated_cycles > 0 ? 100.0 * busy / simulated_cycles : 0.0;
+            };
+            double mean_busy = std::accumulate(link_busy_cycles.begin(), link_busy_cycles.end(), 0.0) /
+                               link_busy_cycles.size();
+
+            // Busiest links first; every link when there are few of them
+            std::vector<size_t> order(link_busy_cycles.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+                return link_busy_cycles[a] > link_busy_cycles[b];
+            });
+            size_t shown = std::min<size_t>(order.size(), MAX_REPORTED_LINKS);
+
+            ss << std::setprecision(2)
+               << "\nNetwork (" << topology << "):\n"
+               << "  Traversals:        " << network_traversals << "\n"
+               << "  Hops/Traversal:    " << mean_hops << "\n"
+               << "  Contention Cycles: " << link_contention_cycles << "\n"
+               << "  Links:             " << link_busy_cycles.size() << "\n"
+               << "  Mean Link Use:     " << utilization(mean_busy) << "%\n"
+               << "  Link Utilization" << (shown < order.size() ? " (busiest):\n" : ":\n");
+            for (size_t i = 0; i < shown; i++) {
+                size_t link = order[i];
+                ss << "    " << std::left << std::setw(16) << link_names[link] << std::right
+                   << utilization(link_busy_cycles[link]) << "%\n";
+            }
+        }
+        ss << "====================================\n";
 
         return ss.str();
     }
 };
 
 /**
- * @brief Comparator for prioritizing messages based on QoS.
+ * @brief Ingress queue, virtual clock and stats of one interconnect worker.
  *
- * Ensures that messages with higher QoS values are processed first.
+ * Every worker owns a subset of the shared memory banks and services only
+ * the messages addressed to them, so messages to the same address always go
+ * through the same queue and are handled in arrival order.
  */
-struct QoSComparator {
-    /**
-     * @brief Compares two messages based on their QoS values.
-     *
-     * @param a The first message.
-     * @param b The second message.
-     * @return True if the QoS of message `a` is less than that of message `b`.
-     */
-    bool operator()(const Message& a, const Message& b) {
-        return a.qos < b.qos; // Higher QoS is prioritized
-    }
+struct InterconnectWorker {
+    MPSCRingBuffer<Message> fifo_queue;                     // Lock-free FIFO ingress queue
+    std::unique_ptr<Arbiter> arbiter;                       // Arbitrated ingress queue (nullptr: FIFO ring)
+    std::mutex queue_mutex;                                 // Guards the arbiter
+    SimClock clock;                                         // Virtual clock of the worker
+    InterconnectStats stats;                                // Messages serviced by the worker
+
+    std::atomic<bool> parked{false};                        // True while the worker thread sleeps
+    std::mutex wake_mutex;                                  // Mutex paired with wake_cv
+    std::condition_variable wake_cv;                        // Signals new messages or a stop request
+    uint16_t id = 0;                                        // Index of the worker
+
+    explicit InterconnectWorker(size_t queue_capacity) : fifo_queue(queue_capacity) {}
+};
+
+/**
+ * @brief Response to a request whose pieces are serviced by several workers.
+ */
+struct SplitRequest {
+    uint32_t base_addr = 0;                                 // Address of the original request
+    size_t pending = 0;                                     // Pieces not serviced yet
+    uint64_t completion = 0;                                // Latest completion cycle of the pieces
+    Payload data;                                           // Words read by the pieces (READ_MEM)
 };
 
 /**
  * @brief Class representing the interconnect in a multi-core system.
  *
  * Handles communication between processing elements (PEs) and shared memory,
- * supporting FIFO and QoS-based arbitration schemes.
+ * supporting FIFO, QoS, round-robin, WFQ and DRR arbitration schemes.
  */
 class Interconnect {
 private:
     std::vector<ProcessingElement*> pes; // List of registered processing elements
     SharedMemory& memory;                // Reference to shared memory
-    std::queue<Message> fifo_queue;      // FIFO queue for messages
-    std::priority_queue<Message, std::vector<Message>, QoSComparator> qos_queue; // qos queue for messages
-    std::mutex queue_mutex;              // Mutex for thread-safe access to queues
-    bool use_qos_arbitration = false;    // Flag to determine arbitration scheme
+    PayloadArena payload_arena;          // Payload storage of the system (outlives every queued message)
+    size_t queue_capacity;               // Slots of the FIFO ingress ring of each worker
+    std::vector<std::unique_ptr<InterconnectWorker>> workers; // Address-sharded workers (at least one)
+    uint32_t shard_bytes = WORDS_PER_BLOCK * INTERCONNECT_SHARD_BLOCKS * 4; // Bytes of each address shard
+    std::mutex split_mutex;              // Guards split_requests
+    std::unordered_map<uint64_t, SplitRequest> split_requests; // Requests split across shards, by request id
+    ArbitrationScheme scheme;            // Order in which queued messages are serviced
     bool stepping_mode = false;          // Flag to enable stepping mode
     std::atomic<bool> running;           // Flag to process messages
-    InterconnectStats stats;             // Stats of the Interconnect
+    InterconnectStats stats;             // Stats of the Interconnect (all workers)
+    CycleCosts costs;                    // Cycle costs of the virtual clock
+    uint64_t host_delay_us = 0;          // Optional real sleep per message (microseconds)
+    bool coherence_enabled = false;      // PEs use coherent set-associative caches
+    CoherenceProtocol coherence = CoherenceProtocol::MESI;
+    bool use_directory = false;          // Invalidations and snoops go to tracked sharers only
+    Directory block_directory;           // PEs holding each cache block (BROADCAST_INVALIDATE)
+    Network network;                     // Links crossed by requests and responses (ideal by default)
+    uint64_t aging_cycles = 0;           // Wait that raises a queued message one QoS level (0: off)
+
+    WaitPolicy wait_policy = WaitPolicy::BLOCK;     // Behavior while the queues are empty
+    size_t spin_limit = DEFAULT_IDLE_SPIN_LIMIT;    // Empty polls before parking (hybrid policy)
+
+    /**
+     * @brief Gets the memory bank a message is addressed to.
+     *
+     * Memory messages go to the bank holding their first word; invalidations
+     * to the bank their cache block index maps to.
+     *
+     * @param msg The message to route.
+     * @return Index of the bank.
+     */
+    uint32_t bankOf(const Message& msg) const;
+
+    /**
+     * @brief Gets the worker that owns the address shard of a message.
+     *
+     * Shards are shard_bytes long and interleaved over the workers
+     * ((addr / shard_bytes) % workers); invalidations go by cache block index.
+     *
+     * @param msg The message to route.
+     * @return Index of the owning worker.
+     */
+    size_t workerOf(const Message& msg) const;
+
+    /**
+     * @brief Checks whether the words of a memory request lie in more than one shard.
+     *
+     * @param msg The message to check.
+     * @return True if the request must be split across workers.
+     */
+    bool spansShards(const Message& msg) const;
+
+    /**
+     * @brief Enqueues a request as one piece per shard it touches.
+     *
+     * Each piece goes to the worker owning its shard, so every word keeps the
+     * arrival order of its shard. The pieces are joined by joinSplit.
+     *
+     * @param msg The request to split.
+     */
+    void splitRequest(Message&& msg);
+
+    /**
+     * @brief Adds a serviced piece to its split request.
+     *
+     * @param worker The worker that serviced the piece.
+     * @param piece The serviced piece.
+     * @param resp Response to the piece; replaced by the response to the whole
+     *             request when the last piece is joined.
+     * @return True if every piece has been serviced and resp must be delivered.
+     */
+    bool joinSplit(InterconnectWorker& worker, const Message& piece, Message& resp);
+
+    /**
+     * @brief Adds a message to the ingress queue of a worker and wakes it.
+     *
+     * @param worker The worker that services the message.
+     * @param msg The message to enqueue.
+     */
+    void pushMessage(InterconnectWorker& worker, Message&& msg);
+
+    /**
+     * @brief Checks whether the active queue of a worker holds at least one message.
+     *
+     * @param worker The worker to check.
+     * @return True if a message is waiting to be processed.
+     */
+    bool hasPendingMessages(InterconnectWorker& worker);
+
+    /**
+     * @brief Wakes a worker thread if it is parked.
+     *
+     * @param worker The worker that received a message.
+     */
+    void notifyConsumer(InterconnectWorker& worker);
+
+    /**
+     * @brief Waits for new messages according to the configured wait policy.
+     *
+     * @param worker The worker that found its queue empty.
+     * @param idle_polls Number of consecutive empty polls, updated by the call.
+     */
+    void waitForMessages(InterconnectWorker& worker, size_t& idle_polls);
+
+    /**
+     * @brief Removes the next message of a worker according to the arbitration scheme.
+     *
+     * Must only be called from the thread that runs the worker.
+     *
+     * @param worker The worker to dequeue from.
+     * @param msg Destination of the removed message.
+     * @param current_qsize Queue size observed before removing the message.
+     * @return True if a message was removed, false if the queue is empty.
+     */
+    bool dequeueMessage(InterconnectWorker& worker, Message& msg, size_t& current_qsize);
+
+    /**
+     * @brief Services a message on a worker, charging its clock and stats.
+     *
+     * @see handleMessage
+     */
+    bool serviceMessage(InterconnectWorker& worker, const Message& msg, size_t current_qsize, Message& resp);
+
+    /**
+     * @brief Services the messages of one worker until processing stops.
+     *
+     * @param worker The worker run by the calling thread.
+     */
+    void runWorker(InterconnectWorker& worker);
+
+    /**
+     * @brief Snoops the line of a coherent request in every PE except the requester.
+     *
+     * Dirty data returned by a snoop is written to memory under MESI (or when
+     * it came from a pending writeback) and handed to the requester.
+     *
+     * @param msg READ_SHARED, READ_EXCLUSIVE or UPGRADE.
+     * @param stats Stats of the worker servicing the request.
+     * @return Whether another PE keeps a copy and, if supplied, the line contents.
+     */
+    SnoopResult snoopOthers(const Message& msg, InterconnectStats& stats);
+
+    /**
+     * @brief Gets the number of PEs an invalidation or coherent request reaches.
+     *
+     * With a directory these are the listed sharers other than the sender;
+     * otherwise every other PE. Updates the directory stats.
+     *
+     * @param msg The message being serviced.
+     * @param stats Stats of the worker servicing the message.
+     * @return PEs to invalidate or snoop (0 for other message types).
+     */
+    size_t snoopTargets(const Message& msg, InterconnectStats& stats);
+
+    /**
+     * @brief Gives a worker an empty arbiter of the current scheme and aging.
+     */
+    void configureArbiter(InterconnectWorker& worker);
 
 public:
     /**
      * @brief Constructor for the Interconnect class.
      *
      * @param mem Reference to shared memory.
-     * @param use_qos Flag indicating whether to use QoS-based arbitration.
+     * @param arbitration Arbitration scheme.
+     * @param queue_capacity Slots of the FIFO ingress ring. Must cover every
+     *        request that can be outstanding at once when the producers and
+     *        the consumer share a thread (discrete-event engine).
      */
-    Interconnect(SharedMemory& mem, bool use_qos);
+    Interconnect(SharedMemory& mem, ArbitrationScheme arbitration,
+                 size_t queue_capacity = INTERCONNECT_QUEUE_CAPACITY);
 
     /**
      * @brief Gets the InterconnectStats struct of the interconnect.
@@ -135,6 +666,8 @@ public:
     /**
      * @brief Registers a processing element (PE) with the interconnect.
      *
+     * The PE allocates its outgoing payloads from the interconnect arena.
+     *
      * @param pe Pointer to the processing element to register.
      */
     void registerPE(ProcessingElement* pe);
@@ -142,9 +675,11 @@ public:
     /**
      * @brief Sets the arbitration scheme for message processing.
      *
-     * @param use_qos Flag indicating whether to use QoS-based arbitration.
+     * Must be called before any message is enqueued.
+     *
+     * @param arbitration Arbitration scheme.
      */
-    void setArbitrationScheme(bool use_qos);
+    void setArbitrationScheme(ArbitrationScheme arbitration);
 
     /**
      * @brief Sets the stepping mode for message processing.
@@ -153,23 +688,168 @@ public:
      */
     void setSteppingMode(bool enable);
 
+    /**
+     * @brief Sets the cycle costs charged by the virtual clock.
+     *
+     * @param cycle_costs Costs per message type.
+     */
+    void setCycleCosts(const CycleCosts& cycle_costs);
+
+    /**
+     * @brief Enables the coherence protocol of the set-associative PE caches.
+     *
+     * @param protocol MESI or MOESI.
+     */
+    void enableCoherence(CoherenceProtocol protocol);
+
+    /**
+     * @brief Sends invalidations and snoops only to the PEs that hold the line.
+     *
+     * Allocates the cache block directory and, for set-associative caches,
+     * the line directory of the shared memory. Must be called before the PEs
+     * are registered.
+     *
+     * @param config Sizes of the simulated system.
+     */
+    void enableDirectory(const SystemConfig& config);
+
+    /**
+     * @brief Splits message servicing across several worker threads.
+     *
+     * The address space is cut into shards of shard_words words interleaved
+     * over the workers; each worker keeps its own queue and virtual clock.
+     * Requests crossing a shard boundary are split into one piece per shard.
+     * Must be called before any message is enqueued.
+     *
+     * @param count Number of workers (at least 1).
+     * @param shard_words Words per address shard (at least 1).
+     */
+    void setWorkers(size_t count, uint32_t shard_words);
+
+    /**
+     * @brief Gets the number of interconnect workers.
+     */
+    size_t getWorkers() const;
+
+    /**
+     * @brief Places the PEs and memory banks on an on-chip network.
+     *
+     * Requests then travel from the router of their PE to the router of
+     * their memory bank, and responses back, contending for the links on
+     * the way. IDEAL keeps the network out of the timing.
+     *
+     * @param config Topology, PE count and bank count of the system.
+     */
+    void setTopology(const SystemConfig& config);
+
+    /**
+     * @brief Enables aging in the QoS arbiter of every worker.
+     *
+     * A queued message gains one QoS level for every `cycles` it has waited
+     * since it was issued, so a steady stream of high-QoS traffic can delay
+     * a low-QoS PE but not starve it. Only affects QoS arbitration.
+     *
+     * @param cycles Waiting cycles per level (0 keeps strict priority).
+     */
+    void setQoSAging(uint64_t cycles);
+
+    /**
+     * @brief Gets the cycle costs charged by the virtual clock.
+     *
+     * @return The cycle costs of the interconnect.
+     */
+    const CycleCosts& getCycleCosts() const;
+
+    /**
+     * @brief Gets the current cycle of the interconnect virtual clock.
+     *
+     * @return The simulated cycle at which the interconnect becomes free
+     *         (the latest worker clock).
+     */
+    uint64_t now() const;
+
+    /**
+     * @brief Sets an optional real delay applied to every message.
+     *
+     * Only useful to observe queueing with wall-clock timing; simulated
+     * cycles are not affected.
+     *
+     * @param delay_us Delay in microseconds (0 disables it).
+     */
+    void setHostDelay(uint64_t delay_us);
+
+    /**
+     * @brief Sets how the interconnect thread waits while there are no messages.
+     *
+     * @param policy Wait policy to use.
+     * @param spin_polls Empty polls before parking when using SPIN_THEN_PARK.
+     */
+    void setWaitPolicy(WaitPolicy policy, size_t spin_polls = DEFAULT_IDLE_SPIN_LIMIT);
+
     /**
      * @brief Enqueues a message into the appropriate queue based on the arbitration scheme.
      *
+     * In FIFO mode the message goes through the lock-free ring buffer; the call
+     * only yields if the ring is full. The interconnect takes ownership of the
+     * message and its payload.
+     *
      * @param msg The message to enqueue.
      */
-    void enqueueMessage(const Message& msg);
+    void enqueueMessage(Message&& msg);
 
     /**
      * @brief Sets the running flag to false to stop processing messages.
+     *
+     * Wakes every parked worker thread.
      */
     void stopProcessing();
 
+    /**
+     * @brief Removes the next message of the first worker according to the arbitration scheme.
+     *
+     * Must only be called from the thread that services messages, with a
+     * single worker (discrete-event engine).
+     *
+     * @param msg Destination of the removed message.
+     * @param current_qsize Queue size observed before removing the message.
+     * @return True if a message was removed, false if the queue is empty.
+     */
+    bool dequeueMessage(Message& msg, size_t& current_qsize);
+
+    /**
+     * @brief Services a single message and builds its response.
+     *
+     * Reads or writes shared memory, or invalidates the cache line in the
+     * other PEs, charging the corresponding cycles on the virtual clock.
+     * Coherent requests snoop the other PEs and are applied to the
+     * requester's cache before returning.
+     * The response is not delivered; the caller decides when it arrives.
+     * Charges the clock and stats of the first worker.
+     *
+     * @param msg The message to service.
+     * @param current_qsize Queue size observed when the message was removed.
+     * @param resp Response for the source PE.
+     * @return True if a response was produced, false for unknown message types.
+     * @throws std::runtime_error If the address is not aligned to 4 bytes.
+     */
+    bool handleMessage(const Message& msg, size_t current_qsize, Message& resp);
+
+    /**
+     * @brief Blocks until the user presses Enter when stepping mode is enabled.
+     */
+    void waitForStep();
+
+    /**
+     * @brief Logs the final interconnect stats.
+     */
+    void saveStats();
+
     /**
      * @brief Processes messages from the queue and performs actions based on their types.
      *
      * This method continuously processes messages, reading from shared memory,
      * writing to shared memory, or broadcasting cache invalidations as needed.
+     * The calling thread runs the first worker; the others get a thread each.
      */
     void processMessages();
 };
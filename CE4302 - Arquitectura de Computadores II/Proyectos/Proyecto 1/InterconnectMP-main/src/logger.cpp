@@ -1,6 +1,40 @@
 #include <iostream>
+#include <algorithm>
 #include "logger.hpp"
 
+LogLevel Logger::min_level = LogLevel::TRACE;
+bool Logger::categories[static_cast<size_t>(LogCategory::NUM_CATEGORIES)] = {true, true};
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE: return "trace";
+        case LogLevel::DEBUG: return "debug";
+        case LogLevel::INFO: return "info";
+        case LogLevel::WARN: return "warn";
+        case LogLevel::ERROR: return "error";
+        case LogLevel::OFF: return "off";
+    }
+    return "unknown";
+}
+
+const char* Logger::categoryName(LogCategory category) {
+    switch (category) {
+        case LogCategory::INTERCONNECT: return "interconnect";
+        case LogCategory::PE: return "pe";
+        default: return "unknown";
+    }
+}
+
+std::vector<Logger*>& Logger::instances() {
+    static std::vector<Logger*> loggers;
+    return loggers;
+}
+
+std::mutex& Logger::instancesMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
 std::string Logger::get_current_timestamp() {
     auto now = std::chrono::system_clock::now();
     auto in_time_t = std::chrono::system_clock::to_time_t(now);
@@ -10,23 +44,59 @@ std::string Logger::get_current_timestamp() {
     return ss.str();
 }
 
+const std::string& Logger::formatTimestamp(std::chrono::system_clock::time_point time) {
+    std::time_t second = std::chrono::system_clock::to_time_t(time);
+    if (second != cached_second) {
+        std::tm local{};
+        localtime_r(&second, &local);
+        std::stringstream ss;
+        ss << std::put_time(&local, "%Y-%m-%d %X");
+        cached_timestamp = ss.str();
+        cached_second = second;
+    }
+    return cached_timestamp;
+}
+
 Logger::Logger(const std::string& filename, bool console_output)
     : filename(filename), console_output(console_output) {
+    static std::atomic<uint64_t> next_id{0};
+    instance_id = next_id++;
+
     if (!filename.empty()) {
         log_file.open(filename, std::ios::out | std::ios::trunc);
         if (!log_file.is_open()) {
             throw std::runtime_error("Failed to open log file");
         }
     }
+
+    std::lock_guard<std::mutex> lock(instancesMutex());
+    instances().push_back(this);
 }
 
 Logger::~Logger() {
+    stopAsync();
+    {
+        std::lock_guard<std::mutex> lock(instancesMutex());
+        auto& loggers = instances();
+        loggers.erase(std::remove(loggers.begin(), loggers.end(), this), loggers.end());
+    }
     if (log_file.is_open()) {
         log_file.close();
     }
 }
 
 void Logger::log(const std::string& message, const std::string& source) {
+    if (async_mode.load(std::memory_order_acquire)) {
+        Record record{std::chrono::system_clock::now(), source.empty() ? message : "[" + source + "] " + message};
+        Ring& ring = localRing();
+        if (overflow == LogOverflow::BLOCK) {
+            ring.push(std::move(record));
+        } else if (!ring.tryPush(std::move(record))) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(log_mutex);
     std::string timestamp = get_current_timestamp();
     std::string log_entry;
@@ -45,3 +115,108 @@ void Logger::log(const std::string& message, const std::string& source) {
         log_file << log_entry << std::endl;
     }
 }
+
+Logger::Ring& Logger::localRing() {
+    // Logger IDs are never reused, so entries of destroyed loggers are never matched
+    thread_local std::vector<std::pair<uint64_t, Ring*>> cache;
+    for (const auto& [id, ring] : cache) {
+        if (id == instance_id) return *ring;
+    }
+
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    rings.push_back(std::make_unique<Ring>(ring_capacity));
+    cache.emplace_back(instance_id, rings.back().get());
+    return *rings.back();
+}
+
+size_t Logger::drain(std::string& batch) {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    size_t records = 0;
+    Record record;
+    for (auto& ring : rings) {
+        // At most one lap per ring, so a busy thread cannot starve the others
+        for (size_t i = 0; i < ring->capacity() && ring->tryPop(record); i++) {
+            batch += "\n[";
+            batch += formatTimestamp(record.time);
+            batch += "] ";
+            batch += record.text;
+            batch += '\n';
+            records++;
+        }
+    }
+    return records;
+}
+
+void Logger::writeBatch(const std::string& batch) {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    if (console_output) {
+        std::cout << batch << std::flush;
+    }
+    if (log_file.is_open()) {
+        log_file << batch;
+        log_file.flush();
+    }
+}
+
+void Logger::writerLoop() {
+    std::string batch;
+    while (writer_running.load(std::memory_order_acquire)) {
+        batch.clear();
+        if (drain(batch) == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(LOGGER_IDLE_SLEEP_US));
+            continue;
+        }
+        writeBatch(batch);
+    }
+}
+
+void Logger::startAsync(LogOverflow policy, size_t capacity) {
+    if (async_mode.load()) return;
+
+    overflow = policy;
+    {
+        // Rings of an earlier session keep their capacity
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        ring_capacity = capacity;
+    }
+    dropped.store(0, std::memory_order_relaxed);
+    writer_running.store(true, std::memory_order_release);
+    writer = std::thread(&Logger::writerLoop, this);
+    async_mode.store(true, std::memory_order_release);
+}
+
+uint64_t Logger::stopAsync() {
+    if (!async_mode.load()) return 0;
+
+    async_mode.store(false, std::memory_order_release);
+    writer_running.store(false, std::memory_order_release);
+    writer.join();
+
+    std::string batch;
+    while (drain(batch) > 0) {
+        writeBatch(batch);
+        batch.clear();
+    }
+
+    uint64_t lost = dropped.load(std::memory_order_relaxed);
+    if (lost > 0) {
+        log(std::to_string(lost) + " log records dropped (ring full)", "Logger");
+    }
+    return lost;
+}
+
+void Logger::startAsyncAll(LogOverflow policy, size_t capacity) {
+    std::lock_guard<std::mutex> lock(instancesMutex());
+    for (Logger* logger : instances()) {
+        logger->startAsync(policy, capacity);
+    }
+}
+
+uint64_t Logger::stopAsyncAll() {
+    std::lock_guard<std::mutex> lock(instancesMutex());
+    uint64_t lost = 0;
+    for (Logger* logger : instances()) {
+        lost += logger->stopAsync();
+    }
+    return lost;
+}
@@ -7,20 +7,109 @@
 #include <iomanip>
 #include <chrono>
 #include <sstream>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "constants.hpp"
+#include "mpsc_ring_buffer.hpp"
+
+/**
+ * @brief Severity of a log entry.
+ */
+enum class LogLevel : uint8_t {
+    TRACE,      // Every message through the interconnect
+    DEBUG,
+    INFO,       // Start and end of a run
+    WARN,       // Discarded messages
+    ERROR,
+    OFF
+};
+
+/**
+ * @brief Component that writes a log entry.
+ */
+enum class LogCategory : uint8_t {
+    INTERCONNECT,
+    PE,
+    NUM_CATEGORIES
+};
+
+// Entries below this level are compiled out (0: TRACE ... 5: OFF), e.g. make LOG_COMPILE_LEVEL=3
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0
+#endif
+
+constexpr LogLevel COMPILED_LOG_LEVEL = static_cast<LogLevel>(LOG_COMPILE_LEVEL);
+
+/**
+ * @brief Runs a logging statement if its level and category are enabled.
+ *
+ * Below LOG_COMPILE_LEVEL the statement, including the formatting of its
+ * arguments, is discarded at compile time; above it, Logger::enabled
+ * filters it at runtime.
+ */
+#define LOG_AT(level, category, ...)                                                \
+    do {                                                                            \
+        if constexpr ((level) >= COMPILED_LOG_LEVEL) {                              \
+            if (Logger::enabled(level, category)) {                                 \
+                __VA_ARGS__;                                                        \
+            }                                                                       \
+        }                                                                           \
+    } while (0)
+
+/**
+ * @brief What an asynchronous logger does when the ring of a thread is full.
+ */
+enum class LogOverflow {
+    DROP,       // Discard the record and count it
+    BLOCK       // Yield until the writer thread frees a slot
+};
 
 /**
  * @brief A simple logger class that supports logging to a file and/or console.
  *
  * This class provides a way to log messages with timestamps and optional sources,
  * and can output logs to both a file and the console.
+ *
+ * In asynchronous mode each calling thread pushes its records into its own
+ * lock-free ring (LOGGER_RING_CAPACITY records), and a background writer
+ * thread drains every ring, formats the timestamps and writes the records in
+ * batches. Records of one thread keep their order; records of different
+ * threads are interleaved in drain order. Memory stays bounded: a full ring
+ * either drops the record or makes its thread wait, as chosen when the mode
+ * is started.
  */
 class Logger {
 private:
+    /**
+     * @brief Record waiting in a ring for the writer thread.
+     */
+    struct Record {
+        std::chrono::system_clock::time_point time;
+        std::string text;       // Message, prefixed with "[source] " if any
+    };
+
+    using Ring = MPSCRingBuffer<Record>;
+
     std::ofstream log_file;     // Output stream for the log file
     std::mutex log_mutex;       // Mutex to ensure thread-safe logging
     std::string filename;       // Name of the log file
     bool console_output;        // Flag to enable/disable console output
 
+    // Asynchronous mode
+    uint64_t instance_id;                       // Unique ID, keys the ring cache of each thread
+    std::atomic<bool> async_mode{false};        // Records go through the rings
+    LogOverflow overflow = LogOverflow::DROP;
+    size_t ring_capacity = LOGGER_RING_CAPACITY;
+    std::vector<std::unique_ptr<Ring>> rings;   // One per producer thread, kept until destruction
+    std::mutex rings_mutex;                     // Guards rings
+    std::thread writer;                         // Drains the rings
+    std::atomic<bool> writer_running{false};
+    std::atomic<uint64_t> dropped{0};           // Records discarded by full rings
+    std::time_t cached_second = -1;             // Second of cached_timestamp (writer only)
+    std::string cached_timestamp;
+
     /**
      * @brief Internal function to format the current timestamp.
      *
@@ -28,6 +117,46 @@ private:
      */
     std::string get_current_timestamp();
 
+    /**
+     * @brief Formats the timestamp of a record, reusing the previous one within the same second.
+     */
+    const std::string& formatTimestamp(std::chrono::system_clock::time_point time);
+
+    /**
+     * @brief Gets the ring of the calling thread, registering it on first use.
+     */
+    Ring& localRing();
+
+    /**
+     * @brief Moves every queued record into a batch of formatted entries.
+     *
+     * @return Number of records drained.
+     */
+    size_t drain(std::string& batch);
+
+    /**
+     * @brief Writes a batch of entries to the console and/or the file.
+     */
+    void writeBatch(const std::string& batch);
+
+    /**
+     * @brief Body of the writer thread.
+     */
+    void writerLoop();
+
+    static LogLevel min_level;                                  // Runtime level filter
+    static bool categories[static_cast<size_t>(LogCategory::NUM_CATEGORIES)];   // Runtime category filter
+
+    /**
+     * @brief Gets every live logger.
+     */
+    static std::vector<Logger*>& instances();
+
+    /**
+     * @brief Guards instances().
+     */
+    static std::mutex& instancesMutex();
+
 public:
     /**
      * @brief Logger class constructor.
@@ -42,7 +171,7 @@ public:
     /**
      * @brief Logger class destructor.
      *
-     * Closes the log file if it is open.
+     * Writes the pending records and closes the log file if it is open.
      */
     ~Logger();
 
@@ -54,6 +183,70 @@ public:
      */
     void log(const std::string& message, const std::string& source = "");
 
+    /**
+     * @brief Switches to asynchronous logging and starts the writer thread.
+     *
+     * @param policy What to do with a record when the ring of its thread is full.
+     * @param capacity Records buffered per producer thread.
+     */
+    void startAsync(LogOverflow policy, size_t capacity = LOGGER_RING_CAPACITY);
+
+    /**
+     * @brief Writes every pending record, stops the writer thread and goes back to synchronous logging.
+     *
+     * No thread may log concurrently with this call. Dropped records are
+     * reported with one final entry in the log.
+     *
+     * @return Records dropped since startAsync.
+     */
+    uint64_t stopAsync();
+
+    /**
+     * @brief Gets the number of records discarded by full rings since startAsync.
+     */
+    uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Switches every logger to asynchronous logging.
+     */
+    static void startAsyncAll(LogOverflow policy, size_t capacity = LOGGER_RING_CAPACITY);
+
+    /**
+     * @brief Flushes and stops the asynchronous mode of every logger.
+     *
+     * @return Records dropped by all loggers.
+     */
+    static uint64_t stopAsyncAll();
+
+    /**
+     * @brief Sets the lowest level logged at runtime (entries below LOG_COMPILE_LEVEL stay compiled out).
+     */
+    static void setLevel(LogLevel level) { min_level = level; }
+
+    /**
+     * @brief Enables or disables the entries of a category at runtime.
+     */
+    static void setCategory(LogCategory category, bool enabled) {
+        categories[static_cast<size_t>(category)] = enabled;
+    }
+
+    /**
+     * @brief Checks the runtime filters. Must not be changed while the simulation runs.
+     */
+    static bool enabled(LogLevel level, LogCategory category) {
+        return level >= min_level && categories[static_cast<size_t>(category)];
+    }
+
+    /**
+     * @brief Gets the name of a level, as accepted by --log-level.
+     */
+    static const char* levelName(LogLevel level);
+
+    /**
+     * @brief Gets the name of a category, as accepted by --log-filter.
+     */
+    static const char* categoryName(LogCategory category);
+
     // Disable copy constructor and assignment operator
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
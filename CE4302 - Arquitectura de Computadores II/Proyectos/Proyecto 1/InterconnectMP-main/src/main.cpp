@@ -6,9 +6,14 @@
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <filesystem>
 #include "processing_element.hpp"
 #include "interconnect.hpp"
 #include "shared_memory.hpp"
+#include "event_engine.hpp"
+#include "system_config.hpp"
+#include "logger.hpp"
+#include "event_log.hpp"
 
 /**
  * Displays program usage instructions
@@ -19,11 +24,74 @@ void show_usage(const std::string& program_name) {
               << "Options:\n"
               << "  -n, --num-pes NUM    Number of PEs to create (" << (int)MIN_NUM_PES 
               << "-" << (int)MAX_NUM_PES <<", default: " << (int)DEFAULT_NUM_PES << ")\n"
-              << "  -s, --scheme SCHEME  Arbitration scheme (fifo|qos, default: fifo)\n"
+              << "  -m, --memory-size N  Shared memory size in 32-bit positions (default: " << SHARED_MEMORY_SIZE << ")\n"
+              << "  -c, --cache-blocks N Cache blocks per PE (default: " << NUMBER_OF_CACHE_BLOCKS << ")\n"
+              << "  -b, --block-words N  32-bit words per cache block (default: " << WORDS_PER_BLOCK << ")\n"
+              << "  -k, --banks N        Shared memory banks (default: " << DEFAULT_MEMORY_BANKS << ")\n"
+              << "  -C, --cache-mode M   PE cache model (scratchpad|setassoc, default: scratchpad)\n"
+              << "      --sets N         Sets of the set-associative cache (default: " << DEFAULT_CACHE_SETS << ")\n"
+              << "      --ways N         Associativity of the set-associative cache (default: " << DEFAULT_CACHE_WAYS << ")\n"
+              << "      --line-words N   32-bit words per set-associative cache line (default: " << DEFAULT_LINE_WORDS << ")\n"
+              << "      --replacement P  Replacement policy (lru|plru, default: lru)\n"
+              << "      --coherence P    Coherence protocol of the set-associative caches (mesi|moesi, default: mesi)\n"
+              << "      --invalidation M Invalidation/snoop delivery (directory|broadcast, default: directory)\n"
+              << "      --mshrs N        Requests each PE may have in flight (1-" << MAX_MSHRS
+              << ", default: " << DEFAULT_MSHRS << ", scratchpad only)\n"
+              << "  -T, --topology T     Network between PEs and memory banks (ideal|bus|ring|mesh|torus|crossbar, default: ideal)\n"
+              << "  -s, --scheme SCHEME  Arbitration scheme (fifo|qos|rr|wfq|drr, default: fifo)\n"
+              << "  -a, --aging N        Waiting cycles that raise a queued message one QoS level (default: 0, off)\n"
+              << "  -e, --engine ENGINE  Simulation engine (threads|events, default: threads)\n"
+              << "  -W, --workers N      Interconnect worker threads, each owning every N-th " << INTERCONNECT_SHARD_BLOCKS << "-block shard of memory (1-"
+              << MAX_INTERCONNECT_WORKERS << ", default: " << DEFAULT_INTERCONNECT_WORKERS << ", threads engine only)\n"
+              << "  -d, --delay US       Real delay per interconnect message in microseconds (default: 0)\n"
+              << "  -w, --wait POLICY    Interconnect idle wait policy (spin|block|hybrid, default: block)\n"
+              << "      --cache-dir DIR  Save the final cache of every PE in DIR (default: PEs 0-"
+              << NUM_WORKLOAD_FILES - 1 << " only, in ../resources/pe_cache)\n"
+              << "      --trace FILE     Write request spans as Chrome trace-event JSON (Perfetto, chrome://tracing)\n"
+              << "      --trace-sample N Trace one request in N (default: 1, every request)\n"
+              << "  -g, --traffic P      Generate synthetic workloads instead of reading files\n"
+              << "                       (uniform|hotspot|strided|prodcons|migratory|alltoone)\n"
+              << "      --traffic-length N Synthetic instructions per PE (default: " << DEFAULT_TRAFFIC_LENGTH << ")\n"
+              << "      --traffic-mix R,W,I Percentages of READ_MEM, WRITE_MEM and BROADCAST_INVALIDATE (default: 60,30,10)\n"
+              << "      --traffic-stride N Blocks between strided accesses (default: 1)\n"
+              << "      --seed N         Seed of the synthetic workloads (default: 1)\n"
+              << "      --workload-format F Workload files read (text: inst_pe_N.txt, binary: inst_pe_N.bin from make workloads, default: text)\n"
+              << "      --log-level L    Lowest level logged (trace|debug|info|warn|error|off, default: trace)\n"
+              << "      --log-filter C   Comma-separated categories logged (interconnect,pe, default: all)\n"
+              << "      --async-log P    Write the logs from a background thread (drop|block when a ring is full, default: off)\n"
+              << "      --log-format F   Message logs as text or as binary records for tools/decode_log (text|binary, default: text)\n"
               << "  -t, --stepping       Enable step-by-step execution mode\n"
               << "  -h, --help           Show this help message\n";
 }
 
+/**
+ * Parses the numeric value that follows a command-line option
+ * @param i Index of the option, advanced past its value
+ * @param argc Argument count
+ * @param argv Argument values
+ * @param value Parsed value (decimal or 0x-prefixed hexadecimal)
+ * @return True if the value was parsed, false otherwise (an error is printed)
+ */
+bool parseNumericOption(int& i, int argc, char* argv[], uint64_t& value) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+        std::cerr << "Error: Missing argument for " << arg << "\n";
+        return false;
+    }
+    try {
+        size_t processed = 0;
+        std::string text = argv[++i];
+        value = std::stoull(text, &processed, 0);
+        if (processed != text.size()) {
+            throw std::invalid_argument(text);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid argument for " << arg << ": " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
 bool getUserConfirmation(const std::string& prompt) {
     std::string input;
     while (true) {
@@ -40,6 +108,57 @@ bool getUserConfirmation(const std::string& prompt) {
     }
 }
 
+/**
+ * Runs the simulation with one thread per PE plus one for the interconnect
+ * @param interconnect The interconnect servicing the PEs
+ * @param pes The processing elements to run
+ */
+void runWithThreads(Interconnect& interconnect, std::vector<std::unique_ptr<ProcessingElement>>& pes) {
+    std::vector<std::thread> pe_threads;
+
+    // Start interconnect thread
+    std::thread interconnect_thread([&interconnect]() {
+        interconnect.processMessages();
+    });
+
+    //// Start PE threads
+    //for (auto& pe : pes) {
+    //    pe_threads.emplace_back([&interconnect, pe_ptr = pe.get()]() {
+    //        pe_ptr->process(interconnect);
+    //    });
+    //}
+
+    // Create a vector of indices for random access
+    std::vector<size_t> pe_indices(pes.size());
+    std::iota(pe_indices.begin(), pe_indices.end(), 0);
+
+    // Shuffle the indices for random execution order
+    std::random_device rd;
+    std::mt19937 g(rd());
+    std::shuffle(pe_indices.begin(), pe_indices.end(), g);
+
+    // Start PE threads in random order
+    for (size_t idx : pe_indices) {
+        pe_threads.emplace_back([&interconnect, pe_ptr = pes[idx].get()]() {
+            pe_ptr->process(interconnect);
+        });
+        
+        // Add random delay between thread launches (0-10ms)
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(std::uniform_int_distribution<>(0, 10)(g))
+        );
+    }
+
+    // Wait for all PEs to complete
+    for (auto& thread : pe_threads) {
+        thread.join();
+    }
+
+    // Clean shutdown
+    interconnect.stopProcessing();
+    interconnect_thread.join();
+}
+
 /**
  * Main simulation program
  * @param argc Argument count
@@ -48,14 +167,38 @@ bool getUserConfirmation(const std::string& prompt) {
  */
 int main(int argc, char* argv[]) {
     // Default configuration values
-    int num_pes = DEFAULT_NUM_PES;
-    bool use_qos = false;
+    SystemConfig config;
+    ArbitrationScheme scheme = ArbitrationScheme::FIFO;
     bool stepping_mode = false;
+    WaitPolicy wait_policy = WaitPolicy::BLOCK;
+    uint64_t host_delay_us = 0;
+    uint64_t aging_cycles = 0;
+    std::string trace_file;
+    std::string cache_dir;
+    uint64_t trace_sample = 1;
+    bool async_log = false;
+    std::string workload_extension = ".txt";
+    bool synthetic = false;
+    TrafficConfig traffic;
+    LogOverflow log_overflow = LogOverflow::DROP;
+    bool use_event_engine = false;
 
     // QoS values for PEs
     std::vector<uint8_t> pes_qos;
     try {
         pes_qos = loadQoS("../resources/config/qos_config.txt");
+        if (pes_qos.empty()) {
+            throw std::runtime_error("No QoS values found in qos_config.txt");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // Cycle costs of the virtual clock
+    CycleCosts cycle_costs;
+    try {
+        cycle_costs = loadCycleCosts("../resources/config/timing_config.txt");
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return 1;
@@ -67,41 +210,383 @@ int main(int argc, char* argv[]) {
         if (arg == "-h" || arg == "--help") {
             show_usage(argv[0]);
             return 0;
-        } else if (arg == "-n" || arg == "--num-pes") {
+        } else if (arg == "-n" || arg == "--num-pes" || arg == "-m" || arg == "--memory-size" ||
+                   arg == "-c" || arg == "--cache-blocks" || arg == "-b" || arg == "--block-words" ||
+                   arg == "-k" || arg == "--banks" || arg == "--sets" || arg == "--ways" ||
+                   arg == "--line-words" || arg == "--mshrs" || arg == "-W" || arg == "--workers") {
+            uint64_t value;
+            if (!parseNumericOption(i, argc, argv, value)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+            // Clamp to the field width; SystemConfig::validate rejects out-of-range sizes
+            uint32_t clamped = static_cast<uint32_t>(std::min<uint64_t>(value, UINT32_MAX));
+            if (arg == "-n" || arg == "--num-pes") {
+                config.num_pes = static_cast<uint16_t>(std::min<uint64_t>(value, UINT16_MAX));
+            } else if (arg == "-m" || arg == "--memory-size") {
+                config.shared_memory_size = clamped;
+            } else if (arg == "-c" || arg == "--cache-blocks") {
+                config.cache_blocks = clamped;
+            } else if (arg == "-k" || arg == "--banks") {
+                config.memory_banks = clamped;
+            } else if (arg == "--sets") {
+                config.cache_sets = clamped;
+            } else if (arg == "--ways") {
+                config.cache_ways = clamped;
+            } else if (arg == "--line-words") {
+                config.line_words = clamped;
+            } else if (arg == "--mshrs") {
+                config.mshrs = clamped;
+            } else if (arg == "-W" || arg == "--workers") {
+                config.interconnect_workers = clamped;
+            } else {
+                config.words_per_block = clamped;
+            }
+        } else if (arg == "-C" || arg == "--cache-mode") {
             if (i + 1 < argc) {
-                try {
-                    num_pes = std::stoi(argv[++i]);
-                    if (num_pes < MIN_NUM_PES || num_pes > MAX_NUM_PES) {
-                        std::string mensaje = "Number of PEs must be between " + 
-                        std::to_string(MIN_NUM_PES) + " and " + std::to_string(MAX_NUM_PES);
-
-                        throw std::out_of_range(mensaje);
-                    }
-                } catch (const std::exception& e) {
-                    std::cerr << "Error: Invalid argument for --num-pes: " << e.what() << "\n";
+                std::string mode = argv[++i];
+                if (mode == "setassoc") {
+                    config.cache_mode = CacheMode::SET_ASSOCIATIVE;
+                } else if (mode == "scratchpad") {
+                    config.cache_mode = CacheMode::SCRATCHPAD;
+                } else {
+                    std::cerr << "Error: Invalid cache mode. Use 'scratchpad' or 'setassoc'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --cache-mode\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--replacement") {
+            if (i + 1 < argc) {
+                std::string policy = argv[++i];
+                if (policy == "lru") {
+                    config.replacement = ReplacementPolicy::LRU;
+                } else if (policy == "plru") {
+                    config.replacement = ReplacementPolicy::PLRU;
+                } else {
+                    std::cerr << "Error: Invalid replacement policy. Use 'lru' or 'plru'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --replacement\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--coherence") {
+            if (i + 1 < argc) {
+                std::string protocol = argv[++i];
+                if (protocol == "mesi") {
+                    config.coherence = CoherenceProtocol::MESI;
+                } else if (protocol == "moesi") {
+                    config.coherence = CoherenceProtocol::MOESI;
+                } else {
+                    std::cerr << "Error: Invalid coherence protocol. Use 'mesi' or 'moesi'\n";
                     show_usage(argv[0]);
                     return 1;
                 }
             } else {
-                std::cerr << "Error: Missing argument for --num-pes\n";
+                std::cerr << "Error: Missing argument for --coherence\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--invalidation") {
+            if (i + 1 < argc) {
+                std::string mode = argv[++i];
+                if (mode == "directory") {
+                    config.use_directory = true;
+                } else if (mode == "broadcast") {
+                    config.use_directory = false;
+                } else {
+                    std::cerr << "Error: Invalid invalidation mode. Use 'directory' or 'broadcast'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --invalidation\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-T" || arg == "--topology") {
+            if (i + 1 < argc) {
+                std::string topology = argv[++i];
+                const NetworkTopology topologies[] = {
+                    NetworkTopology::IDEAL, NetworkTopology::BUS, NetworkTopology::RING,
+                    NetworkTopology::MESH, NetworkTopology::TORUS, NetworkTopology::CROSSBAR};
+                auto match = std::find_if(std::begin(topologies), std::end(topologies),
+                    [&topology](NetworkTopology t) { return topology == networkTopologyName(t); });
+                if (match == std::end(topologies)) {
+                    std::cerr << "Error: Invalid topology. Use 'ideal', 'bus', 'ring', 'mesh', 'torus' or 'crossbar'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+                config.topology = *match;
+            } else {
+                std::cerr << "Error: Missing argument for --topology\n";
                 show_usage(argv[0]);
                 return 1;
             }
         } else if (arg == "-s" || arg == "--scheme") {
             if (i + 1 < argc) {
-                std::string scheme = argv[++i];
-                if (scheme == "qos") {
-                    use_qos = true;
-                } else if (scheme != "fifo") {
-                    std::cerr << "Error: Invalid scheme. Use 'fifo' or 'qos'\n";
+                std::string name = argv[++i];
+                const ArbitrationScheme schemes[] = {
+                    ArbitrationScheme::FIFO, ArbitrationScheme::QOS, ArbitrationScheme::ROUND_ROBIN,
+                    ArbitrationScheme::WFQ, ArbitrationScheme::DRR};
+                auto match = std::find_if(std::begin(schemes), std::end(schemes),
+                    [&name](ArbitrationScheme s) { return name == arbitrationSchemeName(s); });
+                if (match == std::end(schemes)) {
+                    std::cerr << "Error: Invalid scheme. Use 'fifo', 'qos', 'rr', 'wfq' or 'drr'\n";
                     show_usage(argv[0]);
                     return 1;
                 }
+                scheme = *match;
             } else {
                 std::cerr << "Error: Missing argument for --scheme\n";
                 show_usage(argv[0]);
                 return 1;
             }
+        } else if (arg == "-e" || arg == "--engine") {
+            if (i + 1 < argc) {
+                std::string engine = argv[++i];
+                if (engine == "events") {
+                    use_event_engine = true;
+                } else if (engine != "threads") {
+                    std::cerr << "Error: Invalid engine. Use 'threads' or 'events'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --engine\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-d" || arg == "--delay") {
+            if (!parseNumericOption(i, argc, argv, host_delay_us)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-a" || arg == "--aging") {
+            if (!parseNumericOption(i, argc, argv, aging_cycles)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--cache-dir") {
+            if (i + 1 < argc) {
+                cache_dir = argv[++i];
+            } else {
+                std::cerr << "Error: Missing argument for --cache-dir\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--trace") {
+            if (i + 1 < argc) {
+                trace_file = argv[++i];
+            } else {
+                std::cerr << "Error: Missing argument for --trace\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--trace-sample") {
+            if (!parseNumericOption(i, argc, argv, trace_sample)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+            if (trace_sample == 0 || trace_sample > UINT32_MAX) {
+                std::cerr << "Error: --trace-sample must be between 1 and " << UINT32_MAX << "\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--async-log") {
+            if (i + 1 < argc) {
+                std::string policy = argv[++i];
+                if (policy == "drop") {
+                    log_overflow = LogOverflow::DROP;
+                } else if (policy == "block") {
+                    log_overflow = LogOverflow::BLOCK;
+                } else {
+                    std::cerr << "Error: Invalid log overflow policy. Use 'drop' or 'block'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+                async_log = true;
+            } else {
+                std::cerr << "Error: Missing argument for --async-log\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-g" || arg == "--traffic") {
+            if (i + 1 < argc) {
+                std::string pattern = argv[++i];
+                const TrafficPattern patterns[] = {
+                    TrafficPattern::UNIFORM, TrafficPattern::HOTSPOT, TrafficPattern::STRIDED,
+                    TrafficPattern::PRODUCER_CONSUMER, TrafficPattern::MIGRATORY, TrafficPattern::ALL_TO_ONE};
+                auto match = std::find_if(std::begin(patterns), std::end(patterns),
+                    [&pattern](TrafficPattern p) { return pattern == trafficPatternName(p); });
+                if (match == std::end(patterns)) {
+                    std::cerr << "Error: Invalid traffic pattern. Use 'uniform', 'hotspot', 'strided', "
+                              << "'prodcons', 'migratory' or 'alltoone'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+                traffic.pattern = *match;
+                synthetic = true;
+            } else {
+                std::cerr << "Error: Missing argument for --traffic\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--traffic-length") {
+            if (!parseNumericOption(i, argc, argv, traffic.length)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+            if (traffic.length == 0) {
+                std::cerr << "Error: --traffic-length must be at least 1\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--traffic-mix") {
+            if (i + 1 < argc) {
+                std::stringstream list(argv[++i]);
+                std::string field;
+                std::vector<uint32_t> percents;
+                while (std::getline(list, field, ',')) {
+                    try {
+                        percents.push_back(static_cast<uint32_t>(std::stoul(field)));
+                    } catch (const std::exception&) {
+                        percents.clear();
+                        break;
+                    }
+                }
+                if (percents.size() != 3 || percents[0] + percents[1] + percents[2] != 100) {
+                    std::cerr << "Error: --traffic-mix takes three percentages that add up to 100 (e.g. 60,30,10)\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+                traffic.read_percent = percents[0];
+                traffic.write_percent = percents[1];
+                traffic.invalidate_percent = percents[2];
+            } else {
+                std::cerr << "Error: Missing argument for --traffic-mix\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--traffic-stride") {
+            uint64_t stride = 0;
+            if (!parseNumericOption(i, argc, argv, stride)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+            if (stride == 0 || stride > UINT32_MAX) {
+                std::cerr << "Error: --traffic-stride must be between 1 and " << UINT32_MAX << "\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+            traffic.stride_blocks = static_cast<uint32_t>(stride);
+        } else if (arg == "--seed") {
+            if (!parseNumericOption(i, argc, argv, traffic.seed)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--workload-format") {
+            if (i + 1 < argc) {
+                std::string format = argv[++i];
+                if (format == "binary") {
+                    workload_extension = ".bin";
+                } else if (format != "text") {
+                    std::cerr << "Error: Invalid workload format. Use 'text' or 'binary'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --workload-format\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--log-level") {
+            if (i + 1 < argc) {
+                std::string name = argv[++i];
+                const LogLevel levels[] = {LogLevel::TRACE, LogLevel::DEBUG, LogLevel::INFO,
+                                           LogLevel::WARN, LogLevel::ERROR, LogLevel::OFF};
+                auto it = std::find_if(std::begin(levels), std::end(levels),
+                                       [&](LogLevel level) { return name == Logger::levelName(level); });
+                if (it == std::end(levels)) {
+                    std::cerr << "Error: Invalid log level. Use 'trace', 'debug', 'info', 'warn', 'error' or 'off'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+                Logger::setLevel(*it);
+                if (*it < COMPILED_LOG_LEVEL) {
+                    std::cerr << "Warning: Entries below level '" << Logger::levelName(COMPILED_LOG_LEVEL)
+                              << "' were compiled out (LOG_COMPILE_LEVEL)\n";
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --log-level\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--log-filter") {
+            if (i + 1 < argc) {
+                std::stringstream list(argv[++i]);
+                std::string name;
+                const size_t num_categories = static_cast<size_t>(LogCategory::NUM_CATEGORIES);
+                for (size_t c = 0; c < num_categories; c++) {
+                    Logger::setCategory(static_cast<LogCategory>(c), false);
+                }
+                while (std::getline(list, name, ',')) {
+                    size_t c = 0;
+                    while (c < num_categories && name != Logger::categoryName(static_cast<LogCategory>(c))) {
+                        c++;
+                    }
+                    if (c == num_categories) {
+                        std::cerr << "Error: Invalid log category '" << name << "'. Use 'interconnect' or 'pe'\n";
+                        show_usage(argv[0]);
+                        return 1;
+                    }
+                    Logger::setCategory(static_cast<LogCategory>(c), true);
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --log-filter\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--log-format") {
+            if (i + 1 < argc) {
+                std::string format = argv[++i];
+                if (format == "binary") {
+                    EventLog::setBinary(true);
+                } else if (format != "text") {
+                    std::cerr << "Error: Invalid log format. Use 'text' or 'binary'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --log-format\n";
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-w" || arg == "--wait") {
+            if (i + 1 < argc) {
+                std::string policy = argv[++i];
+                if (policy == "spin") {
+                    wait_policy = WaitPolicy::SPIN;
+                } else if (policy == "block") {
+                    wait_policy = WaitPolicy::BLOCK;
+                } else if (policy == "hybrid") {
+                    wait_policy = WaitPolicy::SPIN_THEN_PARK;
+                } else {
+                    std::cerr << "Error: Invalid wait policy. Use 'spin', 'block' or 'hybrid'\n";
+                    show_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Missing argument for --wait\n";
+                show_usage(argv[0]);
+                return 1;
+            }
         } else if (arg == "-t" || arg == "--stepping") {
             stepping_mode = true;
         } else {
@@ -111,34 +596,97 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    try {
+        config.validate();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        show_usage(argv[0]);
+        return 1;
+    }
+    if (config.interconnect_workers > 1 && (use_event_engine || stepping_mode)) {
+        std::cerr << "Error: Multiple interconnect workers require the threads engine without stepping mode\n";
+        show_usage(argv[0]);
+        return 1;
+    }
+
     try {
         // Initialize shared memory
-        SharedMemory memory;
+        SharedMemory memory(config.shared_memory_size, config.memory_banks);
 
         if (!memory.loadFromFile("../resources/shared_memory/data.txt")) {
             throw std::runtime_error("Failed to load memory contents from file");
         }
 
         // Create interconnect with selected scheme
-        std::cout << "Creating Interconnect with " << (use_qos ? "QoS" : "FIFO") << " arbitration\n";
-        Interconnect interconnect(memory, use_qos);
+        std::cout << "Creating Interconnect with " << arbitrationSchemeLabel(scheme) << " arbitration\n";
+        // Each PE has at most one request per MSHR in flight, so the ingress ring never fills up
+        size_t queue_capacity = std::max<size_t>(INTERCONNECT_QUEUE_CAPACITY,
+                                                 static_cast<size_t>(config.num_pes) * config.mshrs);
+        Interconnect interconnect(memory, scheme, queue_capacity);
+        interconnect.setWaitPolicy(wait_policy);
+        interconnect.setWorkers(config.interconnect_workers, config.words_per_block * INTERCONNECT_SHARD_BLOCKS);
+        interconnect.setCycleCosts(cycle_costs);
+        interconnect.setHostDelay(host_delay_us);
+
+        if (scheme == ArbitrationScheme::QOS && aging_cycles > 0) {
+            std::cout << "QoS aging: one level per " << aging_cycles << " waiting cycles\n";
+            interconnect.setQoSAging(aging_cycles);
+        }
         
         if (stepping_mode) {
             interconnect.setSteppingMode(stepping_mode);
             std::cout << "Stepping mode enabled\n";
         }
 
+        if (config.cache_mode == CacheMode::SET_ASSOCIATIVE) {
+            std::cout << "Using " << config.cache_ways << "-way set-associative PE caches ("
+                      << config.cache_sets << " sets, " << config.line_words << " words per line, "
+                      << replacementPolicyName(config.replacement) << ", "
+                      << coherenceProtocolName(config.coherence) << ")\n";
+            interconnect.enableCoherence(config.coherence);
+        }
+
+        if (config.use_directory) {
+            interconnect.enableDirectory(config);
+        }
+
+        if (config.topology != NetworkTopology::IDEAL) {
+            std::cout << "Routing requests over a " << networkTopologyName(config.topology) << " network\n";
+            interconnect.setTopology(config);
+        }
+
+        if (config.interconnect_workers > 1) {
+            std::cout << "Interconnect split into " << config.interconnect_workers << " workers over "
+                      << config.words_per_block * INTERCONNECT_SHARD_BLOCKS * 4 << "-byte address shards\n";
+        }
+
+        if (config.mshrs > 1) {
+            std::cout << "Non-blocking PEs with " << config.mshrs << " MSHRs each\n";
+        }
+
         // Create Processing Elements
-        std::cout << "Initializing " << num_pes << " PEs...\n";
+        std::cout << "Initializing " << config.num_pes << " PEs...\n";
+        if (synthetic) {
+            std::cout << "Synthetic " << trafficPatternName(traffic.pattern) << " traffic: " << traffic.length
+                      << " instructions per PE (" << traffic.read_percent << "% reads, " << traffic.write_percent
+                      << "% writes, " << traffic.invalidate_percent << "% invalidations, seed " << traffic.seed << ")\n";
+        }
         std::vector<std::unique_ptr<ProcessingElement>> pes;
-        std::vector<std::thread> pe_threads;
 
-        for (int i = 0; i < num_pes; ++i) {
-            auto pe = std::make_unique<ProcessingElement>(pes_qos[i]);
+        for (int i = 0; i < config.num_pes; ++i) {
+            // Workload files and QoS values are reused cyclically beyond the ones provided
+            auto pe = std::make_unique<ProcessingElement>(pes_qos[i % pes_qos.size()], config);
 
-            std::string instructions_file = "../resources/pe_instructions/inst_pe_" + std::to_string(i) + ".txt";
-            if (!pe->loadInstructions(instructions_file)) {
-                std::cerr << "Warning: Failed to load instructions for PE " << i << "\n";
+            if (synthetic) {
+                pe->generateInstructions(traffic);
+            } else {
+                std::string instructions_file = "../resources/pe_instructions/inst_pe_" + std::to_string(i % NUM_WORKLOAD_FILES) + workload_extension;
+                if (!pe->loadInstructions(instructions_file)) {
+                    std::cerr << "Warning: Failed to load instructions for PE " << i << "\n";
+                } else if (pe->getRejectedInstructions() > 0) {
+                    std::cerr << "Warning: Skipped " << pe->getRejectedInstructions()
+                              << " records of an unknown type for PE " << i << "\n";
+                }
             }
             
             pe->setCache(i);
@@ -146,62 +694,67 @@ int main(int argc, char* argv[]) {
         }
 
         // Register PEs with interconnect
+        std::vector<ProcessingElement*> pe_ptrs;
         for (auto& pe : pes) {
             interconnect.registerPE(pe.get());
+            pe_ptrs.push_back(pe.get());
         }
-        
-        // Start interconnect thread
-        std::cout << "\nSimulation start\n";
-        std::thread interconnect_thread([&interconnect]() {
-            interconnect.processMessages();
-        });
 
-        //// Start PE threads
-        //for (auto& pe : pes) {
-        //    pe_threads.emplace_back([&interconnect, pe_ptr = pe.get()]() {
-        //        pe_ptr->process(interconnect);
-        //    });
-        //}
-
-        // Create a vector of indices for random access
-        std::vector<uint8_t> pe_indices(pes.size());
-        std::iota(pe_indices.begin(), pe_indices.end(), 0);
-
-        // Shuffle the indices for random execution order
-        std::random_device rd;
-        std::mt19937 g(rd());
-        std::shuffle(pe_indices.begin(), pe_indices.end(), g);
-
-        // Start PE threads in random order
-        for (uint8_t idx : pe_indices) {
-            pe_threads.emplace_back([&interconnect, pe_ptr = pes[idx].get()]() {
-                pe_ptr->process(interconnect);
-            });
-            
-            // Add random delay between thread launches (0-10ms)
-            std::this_thread::sleep_for(
-                std::chrono::milliseconds(std::uniform_int_distribution<>(0, 10)(g))
-            );
+        if (!trace_file.empty()) {
+            std::cout << "Tracing one request in " << trace_sample << " to " << trace_file << "\n";
+            tracer.enable(static_cast<uint32_t>(trace_sample));
         }
 
-        // Wait for all PEs to complete
-        for (auto& thread : pe_threads) {
-            thread.join();
+        if (async_log) {
+            Logger::startAsyncAll(log_overflow);
         }
 
-        // Clean shutdown
-        interconnect.stopProcessing();
-        interconnect_thread.join();
+        std::cout << "\nSimulation start\n";
 
-        // Save cache states and stats for all PEs
+        if (use_event_engine) {
+            // Single-threaded discrete-event simulation
+            std::cout << "Using discrete-event engine\n";
+            EventSimulator simulator(interconnect, pe_ptrs);
+            simulator.run();
+            interconnect.saveStats();
+            std::cout << simulator.getStats().getSummary();
+        } else {
+            runWithThreads(interconnect, pes);
+        }
+
+        if (!trace_file.empty()) {
+            size_t spans = tracer.writeJson(trace_file);
+            std::cout << "Trace: " << spans << " spans written to " << trace_file << "\n";
+            if (uint64_t overwritten = tracer.getOverwritten()) {
+                std::cerr << "Warning: " << overwritten << " trace spans were overwritten; "
+                          << "raise --trace-sample to keep a complete trace\n";
+            }
+        }
+
+        // Save cache states and stats for all PEs. Only the caches of the shipped
+        // PEs go to resources, so that large runs do not flood the source tree
+        if (!cache_dir.empty()) {
+            std::filesystem::create_directories(cache_dir);
+        }
         for (auto& pe : pes) {
-            std::string cache_file = "../resources/pe_cache/cache_pe_" + std::to_string(pe->getID()) + ".txt";
-            if (!pe->saveCache(cache_file)) {
-                std::cerr << "Warning: Failed to save cache state for PE " << pe->getID() << "\n";
+            if (!cache_dir.empty() || pe->getID() < NUM_WORKLOAD_FILES) {
+                std::string dir = cache_dir.empty() ? "../resources/pe_cache" : cache_dir;
+                std::string cache_file = dir + "/cache_pe_" + std::to_string(pe->getID()) + ".txt";
+                if (!pe->saveCache(cache_file)) {
+                    std::cerr << "Warning: Failed to save cache state for PE " << pe->getID() << "\n";
+                }
             }
             pe->saveStats();
         }
 
+        if (async_log) {
+            // Flush every pending record before the logs are read back
+            if (uint64_t dropped = Logger::stopAsyncAll()) {
+                std::cerr << "Warning: " << dropped << " log records were dropped; "
+                          << "use --async-log block to keep every record\n";
+            }
+        }
+
         std::cout << "\nSimulation completed successfully!\n";
 
         // Ask user if they want to visualize results
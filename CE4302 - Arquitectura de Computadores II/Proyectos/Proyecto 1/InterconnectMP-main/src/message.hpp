@@ -1,8 +1,8 @@
 #ifndef MESSAGE_HPP
 #define MESSAGE_HPP
 
-#include <vector>
 #include <cstdint>
+#include "payload.hpp"
 
 /**
  * @brief Message type used in communication between PEs, Interconnect and Shared Memory.
@@ -14,7 +14,11 @@ enum class MessageType {
     INV_ACK, 
     INV_COMPLETE, 
     READ_RESP, 
-    WRITE_RESP
+    WRITE_RESP,
+    READ_SHARED,        // Coherent line fill for a load
+    READ_EXCLUSIVE,     // Coherent line fill for a store (invalidates other copies)
+    UPGRADE,            // Store to a SHARED/OWNED line (invalidates other copies, no data)
+    WRITEBACK           // Dirty line evicted from a set-associative cache
 };
 
 /**
@@ -25,16 +29,20 @@ enum class MessageType {
  */
 struct Message {
     MessageType type;
-    uint8_t src;                    // Source PE (e.g. 0x00-0x07)
-    uint8_t dest;                   // Destination PE (for responses)
-    uint16_t addr;                  // Shared memory address (multiples of 4)
-    uint16_t size;                  // Number of 32-bit words to read from shared memory
-    uint8_t cache_line;             // For BROADCAST_INVALIDATE
-    uint8_t start_cache_line;       // First cache block
-    uint8_t num_of_cache_lines;     // Number of cache blocks
+    uint16_t src;                   // Source PE (e.g. 0x0000-0x0FFF, 0xFFFF: interconnect)
+    uint16_t dest;                  // Destination PE (for responses)
+    uint32_t addr;                  // Shared memory address (multiples of 4)
+    uint32_t size;                  // Number of 32-bit words to read from shared memory
+    uint32_t cache_line;            // For BROADCAST_INVALIDATE
+    uint32_t start_cache_line;      // First cache block
+    uint32_t num_of_cache_lines;    // Number of cache blocks
     uint8_t qos;                    // PE priority (e.g. 0x00-0xFF)
     uint8_t status;                 // 0x1: OK or 0x0: NOT_OK
-    std::vector<uint32_t> data = {};// 32-bit words. Data (for WRITE_MEM/READ_RESP)
+    Payload data = {};              // 32-bit words. Data (for WRITE_MEM/READ_RESP)
+    uint64_t timestamp = 0;         // Simulated cycle when issued (requests) or completed (responses)
+    bool shared = false;            // READ_RESP to a READ_SHARED: another cache keeps a copy
+    uint32_t req_id = 0;            // Request number within the source PE, echoed by the response
+    bool split = false;             // Piece of a request that spans several interconnect worker shards
 };
 
 #endif // MESSAGE_HPP
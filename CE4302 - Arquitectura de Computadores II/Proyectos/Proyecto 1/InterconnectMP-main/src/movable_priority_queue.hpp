@@ -0,0 +1,73 @@
+#ifndef MOVABLE_PRIORITY_QUEUE_HPP
+#define MOVABLE_PRIORITY_QUEUE_HPP
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Binary max-heap with the interface of std::priority_queue plus
+ *        move-extraction of its top element.
+ *
+ * std::priority_queue only exposes top() as a const reference, which forces
+ * a copy of every element taken out of it. popTop() moves the element out
+ * instead, so queued messages keep their payload storage on the way out.
+ *
+ * @tparam T Element type.
+ * @tparam Compare Strict weak ordering; the greatest element is on top.
+ */
+template <typename T, typename Compare = std::less<T>>
+class MovablePriorityQueue {
+private:
+    std::vector<T> heap;    // Heap storage, ordered by comp
+    Compare comp;
+
+public:
+    MovablePriorityQueue() = default;
+
+    /**
+     * @brief Inserts an element.
+     */
+    void push(T&& item) {
+        heap.push_back(std::move(item));
+        std::push_heap(heap.begin(), heap.end(), comp);
+    }
+
+    void push(const T& item) {
+        heap.push_back(item);
+        std::push_heap(heap.begin(), heap.end(), comp);
+    }
+
+    /**
+     * @brief Gets the greatest element without removing it.
+     */
+    const T& top() const {
+        return heap.front();
+    }
+
+    /**
+     * @brief Removes the greatest element.
+     */
+    void pop() {
+        std::pop_heap(heap.begin(), heap.end(), comp);
+        heap.pop_back();
+    }
+
+    /**
+     * @brief Removes the greatest element and returns it by move.
+     *
+     * The queue must not be empty.
+     */
+    T popTop() {
+        std::pop_heap(heap.begin(), heap.end(), comp);
+        T item = std::move(heap.back());
+        heap.pop_back();
+        return item;
+    }
+
+    size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+};
+
+#endif // MOVABLE_PRIORITY_QUEUE_HPP
@@ -0,0 +1,159 @@
+#ifndef MPSC_RING_BUFFER_HPP
+#define MPSC_RING_BUFFER_HPP
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <cstddef>
+#include <utility>
+#include "constants.hpp"
+
+/**
+ * @brief Bounded lock-free multi-producer/single-consumer ring buffer.
+ *
+ * Every slot carries a sequence number that tells producers and the consumer
+ * whether the slot is free or already published, so no mutex is needed on
+ * either side. Producers claim a slot with a single CAS on the enqueue index,
+ * while the dequeue index is owned by the consumer thread. Slots and both
+ * indices live on separate cache lines to avoid false sharing between PEs.
+ *
+ * @tparam T Element type (must be default constructible and movable).
+ */
+template <typename T>
+class MPSCRingBuffer {
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<size_t> sequence{0};    // Publication state of the slot
+        T value{};                          // Stored element
+    };
+
+    std::vector<Slot> slots;                                // Ring storage (power of two)
+    size_t mask;                                            // capacity - 1
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_pos{0};  // Shared by producers
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_pos{0};  // Written by the consumer only
+
+    /**
+     * @brief Rounds a capacity up to the next power of two (minimum 2).
+     */
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    /**
+     * @brief Constructor allocating the ring storage.
+     *
+     * @param capacity Requested number of slots (rounded up to a power of two).
+     */
+    explicit MPSCRingBuffer(size_t capacity)
+        : slots(roundUpPow2(capacity)), mask(slots.size() - 1) {
+        for (size_t i = 0; i < slots.size(); i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+    MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+
+    /**
+     * @brief Tries to append an element without blocking.
+     *
+     * Safe to call concurrently from any number of producer threads.
+     *
+     * @param item Element to append (moved only on success).
+     * @return True if the element was stored, false if the buffer is full.
+     */
+    template <typename U>
+    bool tryPush(U&& item) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Slot still holds an element from the previous lap
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = std::forward<U>(item);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Appends an element, yielding while the buffer is full.
+     *
+     * @param item Element to append.
+     */
+    template <typename U>
+    void push(U&& item) {
+        while (!tryPush(std::forward<U>(item))) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Removes the oldest element if one is available.
+     *
+     * Must only be called from the single consumer thread.
+     *
+     * @param out Destination of the removed element.
+     * @return True if an element was removed, false if the buffer is empty.
+     */
+    bool tryPop(T& out) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Slot& slot = slots[pos & mask];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+
+        if (seq != pos + 1) {
+            return false;
+        }
+
+        out = std::move(slot.value);
+        slot.sequence.store(pos + mask + 1, std::memory_order_release);
+        dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Gets an approximation of the number of stored elements.
+     *
+     * Exact when called from the consumer with no concurrent producers.
+     *
+     * @return Number of claimed slots not yet consumed.
+     */
+    size_t size() const {
+        size_t head = dequeue_pos.load(std::memory_order_relaxed);
+        size_t tail = enqueue_pos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    /**
+     * @brief Checks whether the buffer appears empty.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Gets the number of slots of the ring.
+     */
+    size_t capacity() const {
+        return slots.size();
+    }
+};
+
+#endif // MPSC_RING_BUFFER_HPP
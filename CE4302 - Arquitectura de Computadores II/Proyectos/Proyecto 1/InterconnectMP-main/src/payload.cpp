@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "payload.hpp"
+
+PayloadArena::PayloadArena() : classes(new SizeClass[NUM_CLASSES]) {}
+
+size_t PayloadArena::classIndex(uint32_t words) {
+    uint32_t rounded = std::bit_ceil(std::max(words, MIN_CLASS_WORDS));
+    return std::countr_zero(rounded) - std::countr_zero(MIN_CLASS_WORDS);
+}
+
+uint32_t* PayloadArena::allocate(uint32_t words, uint32_t& capacity) {
+    blocks_served.fetch_add(1, std::memory_order_relaxed);
+
+    if (words > MAX_CLASS_WORDS) {
+        system_allocations.fetch_add(1, std::memory_order_relaxed);
+        capacity = words;
+        return new uint32_t[words];
+    }
+
+    size_t index = classIndex(words);
+    uint32_t block_words = MIN_CLASS_WORDS << index;
+    SizeClass& size_class = classes[index];
+    capacity = block_words;
+
+    std::lock_guard<std::mutex> lock(size_class.mutex);
+    if (size_class.free_list != nullptr) {
+        FreeBlock* block = size_class.free_list;
+        size_class.free_list = block->next;
+        blocks_recycled.fetch_add(1, std::memory_order_relaxed);
+        return reinterpret_cast<uint32_t*>(block);
+    }
+
+    if (size_class.slab_cursor == size_class.slab_end) {
+        size_t slab_words = std::max<size_t>(SLAB_BYTES / sizeof(uint32_t), block_words);
+        size_class.slabs.emplace_back(new uint32_t[slab_words]);
+        size_class.slab_cursor = size_class.slabs.back().get();
+        size_class.slab_end = size_class.slab_cursor + slab_words;
+        system_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t* block = size_class.slab_cursor;
+    size_class.slab_cursor += block_words;
+    return block;
+}
+
+void PayloadArena::deallocate(uint32_t* block, uint32_t capacity) {
+    if (capacity > MAX_CLASS_WORDS) {
+        delete[] block;
+        return;
+    }
+
+    SizeClass& size_class = classes[classIndex(capacity)];
+    std::lock_guard<std::mutex> lock(size_class.mutex);
+    FreeBlock* free_block = reinterpret_cast<FreeBlock*>(block);
+    free_block->next = size_class.free_list;
+    size_class.free_list = free_block;
+}
+
+std::atomic<uint64_t> Payload::heap_allocations{0};
+std::atomic<uint64_t> Payload::copies{0};
+std::atomic<uint64_t> Payload::copied_bytes{0};
+
+void Payload::recordCopy(const Payload& source) {
+    copies.fetch_add(1, std::memory_order_relaxed);
+    copied_bytes.fetch_add(static_cast<uint64_t>(source.count) * sizeof(uint32_t), std::memory_order_relaxed);
+}
+
+Payload::Payload(std::initializer_list<uint32_t> values) : words{} {
+    append(std::span<const uint32_t>(values.begin(), values.size()));
+}
+
+Payload::Payload(const Payload& other) : words{}, arena(other.arena) {
+    recordCopy(other);
+    append(other);
+}
+
+Payload::Payload(Payload&& other) noexcept
+    : count(other.count), capacity(other.capacity), arena(other.arena) {
+    if (other.isInline()) {
+        std::memcpy(words, other.words, sizeof(words));
+    } else {
+        heap = other.heap;
+        other.capacity = INLINE_WORDS;
+    }
+    other.count = 0;
+}
+
+Payload& Payload::operator=(const Payload& other) {
+    if (this == &other) return *this;
+
+    recordCopy(other);
+    if (other.count > capacity) {
+        release();
+        if (arena == nullptr) {
+            arena = other.arena;
+        }
+    }
+    count = 0;
+    append(other);
+    return *this;
+}
+
+Payload& Payload::operator=(Payload&& other) noexcept {
+    if (this == &other) return *this;
+
+    release();
+    count = other.count;
+    capacity = other.capacity;
+    arena = other.arena;
+    if (other.isInline()) {
+        std::memcpy(words, other.words, sizeof(words));
+    } else {
+        heap = other.heap;
+        other.capacity = INLINE_WORDS;
+    }
+    other.count = 0;
+    return *this;
+}
+
+void Payload::resize(uint32_t new_count) {
+    reserve(new_count);
+    if (new_count > count) {
+        std::fill(data() + count, data() + new_count, 0u);
+    }
+    count = new_count;
+}
+
+void Payload::append(std::span<const uint32_t> values) {
+    reserve(count + static_cast<uint32_t>(values.size()));
+    std::copy(values.begin(), values.end(), data() + count);
+    count += static_cast<uint32_t>(values.size());
+}
+
+void Payload::push_back(uint32_t value) {
+    if (count == capacity) {
+        reserve(capacity * 2);
+    }
+    data()[count++] = value;
+}
+
+void Payload::reserve(uint32_t new_capacity) {
+    if (new_capacity <= capacity) return;
+
+    uint32_t granted;
+    uint32_t* block;
+    if (arena != nullptr) {
+        block = arena->allocate(new_capacity, granted);
+    } else {
+        block = new uint32_t[new_capacity];
+        granted = new_capacity;
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::copy(data(), data() + count, block);
+    uint32_t kept = count;
+    release();
+    heap = block;
+    capacity = granted;
+    count = kept;
+}
+
+void Payload::release() {
+    if (isInline()) return;
+
+    if (arena != nullptr) {
+        arena->deallocate(heap, capacity);
+    } else {
+        delete[] heap;
+    }
+    capacity = INLINE_WORDS;
+}
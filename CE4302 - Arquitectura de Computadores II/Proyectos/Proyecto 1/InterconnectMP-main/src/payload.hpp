@@ -0,0 +1,210 @@
+#ifndef PAYLOAD_HPP
+#define PAYLOAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+#include "constants.hpp"
+
+/**
+ * @brief Slab allocator for message payloads larger than the inline buffer.
+ *
+ * Blocks are grouped in power-of-two size classes (8 words up to
+ * MAX_CLASS_WORDS). Each class carves blocks out of large slabs and keeps
+ * released blocks in a free list, so after warm-up payloads are recycled
+ * without touching the general-purpose allocator. Larger requests go
+ * straight to the heap. One arena is owned by each simulated system and is
+ * shared by the interconnect and every PE.
+ */
+class PayloadArena {
+public:
+    static constexpr uint32_t MIN_CLASS_WORDS = 8;
+    static constexpr uint32_t MAX_CLASS_WORDS = 1u << 16;
+    static constexpr size_t SLAB_BYTES = 64 * 1024;
+
+    PayloadArena();
+    ~PayloadArena() = default;
+
+    PayloadArena(const PayloadArena&) = delete;
+    PayloadArena& operator=(const PayloadArena&) = delete;
+
+    /**
+     * @brief Gets a block able to hold at least the given number of words.
+     *
+     * Thread-safe.
+     *
+     * @param words Requested number of words.
+     * @param capacity Set to the real capacity of the returned block.
+     * @return Pointer to the block.
+     */
+    uint32_t* allocate(uint32_t words, uint32_t& capacity);
+
+    /**
+     * @brief Returns a block obtained from allocate.
+     *
+     * @param block Pointer returned by allocate.
+     * @param capacity Capacity reported by allocate.
+     */
+    void deallocate(uint32_t* block, uint32_t capacity);
+
+    /**
+     * @brief Gets the number of blocks handed out (new and recycled).
+     */
+    uint64_t getBlocksServed() const { return blocks_served.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of blocks served from a free list.
+     */
+    uint64_t getBlocksRecycled() const { return blocks_recycled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of calls to the general-purpose allocator (slabs and oversized blocks).
+     */
+    uint64_t getSystemAllocations() const { return system_allocations.load(std::memory_order_relaxed); }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) SizeClass {
+        std::mutex mutex;                                   // Guards the lists of this class
+        FreeBlock* free_list = nullptr;                     // Released blocks
+        uint32_t* slab_cursor = nullptr;                    // Next unused block of the current slab
+        uint32_t* slab_end = nullptr;
+        std::vector<std::unique_ptr<uint32_t[]>> slabs;     // Owned slabs
+    };
+
+    static constexpr size_t NUM_CLASSES = 14;               // 2^3 .. 2^16 words
+
+    std::unique_ptr<SizeClass[]> classes;
+    std::atomic<uint64_t> blocks_served{0};
+    std::atomic<uint64_t> blocks_recycled{0};
+    std::atomic<uint64_t> system_allocations{0};
+
+    /**
+     * @brief Gets the size class index for a number of words.
+     */
+    static size_t classIndex(uint32_t words);
+};
+
+/**
+ * @brief Data words carried by a Message.
+ *
+ * Up to INLINE_WORDS words live inside the object itself, which covers the
+ * common single-word and single-block transfers without any allocation.
+ * Longer payloads are stored in a block of the bound PayloadArena, or on the
+ * heap when no arena is bound. Offers the subset of the std::vector interface
+ * used by the simulator and converts to std::span for bulk operations.
+ */
+class Payload {
+public:
+    static constexpr uint32_t INLINE_WORDS = 4;
+
+    Payload() noexcept : words{} {}
+    Payload(std::initializer_list<uint32_t> values);
+    Payload(const Payload& other);
+    Payload(Payload&& other) noexcept;
+    Payload& operator=(const Payload& other);
+    Payload& operator=(Payload&& other) noexcept;
+    ~Payload() { release(); }
+
+    /**
+     * @brief Binds the arena used for payloads longer than INLINE_WORDS.
+     *
+     * Must be called while the payload is still stored inline.
+     */
+    void setArena(PayloadArena* arena_) { arena = arena_; }
+    PayloadArena* getArena() const { return arena; }
+
+    uint32_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool isInline() const { return capacity <= INLINE_WORDS; }
+
+    uint32_t* data() { return isInline() ? words : heap; }
+    const uint32_t* data() const { return isInline() ? words : heap; }
+    uint32_t* begin() { return data(); }
+    uint32_t* end() { return data() + count; }
+    const uint32_t* begin() const { return data(); }
+    const uint32_t* end() const { return data() + count; }
+
+    uint32_t& operator[](size_t i) { return data()[i]; }
+    const uint32_t& operator[](size_t i) const { return data()[i]; }
+    uint32_t front() const { return data()[0]; }
+    uint32_t back() const { return data()[count - 1]; }
+
+    operator std::span<uint32_t>() { return {data(), count}; }
+    operator std::span<const uint32_t>() const { return {data(), count}; }
+
+    /**
+     * @brief Resizes the payload; new words are zero.
+     */
+    void resize(uint32_t new_count);
+
+    /**
+     * @brief Appends words at the end of the payload.
+     */
+    void append(std::span<const uint32_t> values);
+
+    /**
+     * @brief Appends one word at the end of the payload.
+     */
+    void push_back(uint32_t value);
+
+    /**
+     * @brief Removes every word, keeping the storage.
+     */
+    void clear() { count = 0; }
+
+    /**
+     * @brief Gets the number of payloads allocated on the heap because no arena was bound.
+     */
+    static uint64_t getHeapAllocations() { return heap_allocations.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of payload copies (copy construction or copy assignment).
+     *
+     * Messages travel between the PEs and the interconnect by move, so any
+     * copy here is payload traffic that did not need to happen.
+     */
+    static uint64_t getCopies() { return copies.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of data bytes moved by payload copies.
+     */
+    static uint64_t getCopiedBytes() { return copied_bytes.load(std::memory_order_relaxed); }
+
+private:
+    union {
+        uint32_t words[INLINE_WORDS];   // Inline storage
+        uint32_t* heap;                 // Arena or heap block when capacity > INLINE_WORDS
+    };
+    uint32_t count = 0;                 // Number of words in use
+    uint32_t capacity = INLINE_WORDS;   // Words available in the current storage
+    PayloadArena* arena = nullptr;      // Source of out-of-line blocks
+
+    static std::atomic<uint64_t> heap_allocations;
+    static std::atomic<uint64_t> copies;
+    static std::atomic<uint64_t> copied_bytes;
+
+    /**
+     * @brief Counts a copy of the given payload.
+     */
+    static void recordCopy(const Payload& source);
+
+    /**
+     * @brief Makes room for at least the given number of words, keeping the contents.
+     */
+    void reserve(uint32_t new_capacity);
+
+    /**
+     * @brief Returns the out-of-line block, if any, and goes back to inline storage.
+     */
+    void release();
+};
+
+#endif // PAYLOAD_HPP
@@ -1,32 +1,38 @@
+#include <algorithm>
 #include "processing_element.hpp"
 #include "interconnect.hpp"
 
 Logger pes_logger("../resources/logs/pes_log.txt", false);
 Logger pes_stats_logger("../resources/logs/pes_stats_log.txt", false);
+EventLog pe_events(pes_logger, "../resources/logs/pes_log.bin");
 
 // Initialization of the static counter
-uint8_t ProcessingElement::next_id = 0;
+uint16_t ProcessingElement::next_id = 0;
 
 void ProcessingElement::setReasons() {
     std::stringstream ss_mem_size;
-    ss_mem_size << "0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << (SHARED_MEMORY_SIZE - 1) * 4;
+    ss_mem_size << "0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << (config.memoryBytes() - 4);
     r_addr1 = "\n\treason: Address is out of range (0x0000 - " + ss_mem_size.str() + ")";
     r_addr2 = "\n\treason: Attempt to access an address after " + ss_mem_size.str();
 
     std::stringstream ss_cache_blocks;
-    ss_cache_blocks << "0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << NUMBER_OF_CACHE_BLOCKS - 1;
+    ss_cache_blocks << "0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << config.cache_blocks - 1;
     r_cache_block1 = "\n\treason: Attempt to invalidate a cache block out of range (0x00 - " + ss_cache_blocks.str() + ")";
     r_cache_block2 = "\n\treason: Attempt to access a cache block out of range (0x00 - " + ss_cache_blocks.str() + ")";
 
     std::stringstream ss_cache_size;
-    ss_cache_size << "0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << NUMBER_OF_CACHE_BLOCKS * WORDS_PER_BLOCK;
+    ss_cache_size << "0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << config.cacheWords();
     r_cache_size = "\n\treason: Size is out of range (0x0001 - " + ss_cache_size.str() + ")";
 }
 
-uint8_t ProcessingElement::getID() {
+uint16_t ProcessingElement::getID() {
     return id;
 }
 
+void ProcessingElement::resetIDs() {
+    next_id = 0;
+}
+
 uint8_t ProcessingElement::getQoS() {
     return qos;
 }
@@ -39,6 +45,14 @@ void ProcessingElement::setCache(uint32_t seed) {
     cache.fillRandom(seed);
 }
 
+void ProcessingElement::setPayloadArena(PayloadArena* arena) {
+    payload_arena = arena;
+}
+
+void ProcessingElement::setBlockDirectory(Directory* directory) {
+    block_directory = directory;
+}
+
 bool ProcessingElement::loadData(const std::string& filename) {
     return cache.loadFromFile(filename);
 }
@@ -47,6 +61,14 @@ bool ProcessingElement::loadInstructions(const std::string& filename) {
     return instructions.loadFromFile(filename);
 }
 
+size_t ProcessingElement::getRejectedInstructions() const {
+    return instructions.getRejected();
+}
+
+void ProcessingElement::generateInstructions(const TrafficConfig& traffic) {
+    instructions.setGenerator(std::make_unique<TrafficGenerator>(traffic, config, id), traffic.length);
+}
+
 bool ProcessingElement::saveCache(const std::string& filename) {
     return cache.saveToFile(filename);
 }
@@ -58,67 +80,67 @@ void ProcessingElement::saveStats() {
     }
 }
 
-void ProcessingElement::sendMessage(Message& msg, Interconnect& interconnect) {
-    auto start = std::chrono::high_resolution_clock::now();
+void ProcessingElement::prepareMessage(Message& msg, const CycleCosts& costs) {
     msg.src = id;
     msg.qos = qos;
 
+    local_cycle += costs.pe_issue;
+    msg.timestamp = local_cycle;
+
     if (msg.addr % 4 != 0) {
         stats.recordDiscardedMessage();
 
-        std::stringstream ss;
-        ss << "0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << msg.addr;
+        LOG_AT(LogLevel::WARN, LogCategory::PE, {
+            std::stringstream ss;
+            ss << "0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << msg.addr;
 
-        std::string message = messageToLog("Message discarded:", msg);
-        message += "\n\treason: Address " + ss.str() + " not aligned to 4 bytes";
+            std::string reason = "\n\treason: Address " + ss.str() + " not aligned to 4 bytes";
 
-        pes_logger.log(message);
+            pe_events.message(EventKind::DISCARDED, msg, reason);
+        });
         throw std::runtime_error("[PE " + std::to_string((int)id) + "]: (Warning) A message was discarded");
     }
 
-    if (msg.addr >= SHARED_MEMORY_SIZE * 4) {
+    if (msg.addr >= config.memoryBytes()) {
         stats.recordDiscardedMessage();
 
-        std::string message = messageToLog("Message discarded:", msg);
-        message += r_addr1;
-
-        pes_logger.log(message);
+        LOG_AT(LogLevel::WARN, LogCategory::PE, pe_events.message(EventKind::DISCARDED, msg, r_addr1));
         throw std::runtime_error("[PE " + std::to_string((int)id) + "]: (Warning) A message was discarded");
     }
 
-    u_int8_t block_index = 0;
+    uint32_t block_index = 0;
     try {
         switch (msg.type) {
             case MessageType::WRITE_MEM: {
                 block_index = msg.start_cache_line;
-                u_int8_t end = msg.num_of_cache_lines;
-                std::vector<uint32_t> block;
+                uint32_t end = msg.num_of_cache_lines;
+                uint64_t block_bytes = config.words_per_block * 4;
                 
-                if (msg.addr + (block_index + end) * 16 > SHARED_MEMORY_SIZE * 4) {
+                if (msg.addr + (static_cast<uint64_t>(block_index) + end) * block_bytes > config.memoryBytes()) {
                     throw std::out_of_range("Address out of range");
                 }
-                if (block_index + end > NUMBER_OF_CACHE_BLOCKS) {
+                if (static_cast<uint64_t>(block_index) + end > config.cache_blocks) {
                     throw std::out_of_range("Block index out of range");
                 }
     
-                for (u_int8_t i = 0; i < end; i++) {
-                    block = cache.readBlock(block_index);
-                    msg.data.insert(msg.data.end(), block.begin(), block.end());
+                msg.data.setArena(payload_arena);
+                for (uint32_t i = 0; i < end; i++) {
+                    msg.data.append(cache.readBlock(block_index));
                     block_index++;
                 }
                 break;
             }
             case MessageType::READ_MEM: {
-                if (msg.size >= SHARED_MEMORY_SIZE || msg.size >= NUMBER_OF_CACHE_BLOCKS * WORDS_PER_BLOCK) {
+                if (msg.size >= config.shared_memory_size || msg.size >= config.cacheWords()) {
                     throw std::out_of_range("Size out of range");
                 }
-                if (msg.addr + msg.size * 4 > SHARED_MEMORY_SIZE * 4) {
+                if (msg.addr + static_cast<uint64_t>(msg.size) * 4 > config.memoryBytes()) {
                     throw std::out_of_range("Address out of range");
                 }
                 break;
             }
             case MessageType::BROADCAST_INVALIDATE: {
-                if (msg.cache_line >= NUMBER_OF_CACHE_BLOCKS) {
+                if (msg.cache_line >= config.cache_blocks) {
                     throw std::out_of_range("Block index out of range");
                 }
                 break;
@@ -134,44 +156,446 @@ void ProcessingElement::sendMessage(Message& msg, Interconnect& interconnect) {
         }
     } catch (const std::exception& e) {
         stats.recordDiscardedMessage();
-        std::string message = messageToLog("Message discarded:", msg);
+        LOG_AT(LogLevel::WARN, LogCategory::PE, {
+            std::string reason;
+
+            if (std::string(e.what()) == "Block index out of range") {
+                if (msg.type == MessageType::BROADCAST_INVALIDATE) {
+                    reason += r_cache_block1;
+                } else {
+                    reason += r_cache_block2;
+                }
+            } else if (std::string(e.what()) == "Attempt to read an invalid block") {
+                std::stringstream ss_cache_block;
+                ss_cache_block << "0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (int)block_index;
+
+                reason += "\n\treason: Attempt to read an invalid cache block (" + ss_cache_block.str() + ")";
+            } else if (std::string(e.what()) == "Size out of range") {
+                reason += r_cache_size;
+            } else if (std::string(e.what()) == "Address out of range") {
+                reason += r_addr2;
+            }
+
+            pe_events.message(EventKind::DISCARDED, msg, reason);
+        });
+        throw std::runtime_error("[PE " + std::to_string((int)id) + "]: (Warning) A message was discarded");
+    }
+}
+
+void ProcessingElement::receiveMessage(Message&& msg) {
+    std::lock_guard<std::mutex> lock(msg_mutex);
+    stats.recordReceivedMessage();
+    incoming_messages.push(std::move(msg));
+    msg_cv.notify_one(); // Notify waiting thread that a message is available
+}
+
+bool ProcessingElement::nextRequest(Message& msg, const CycleCosts& costs) {
+    while (true) {
+        if (!line_requests.empty()) {
+            msg = std::move(line_requests.front());
+            line_requests.pop_front();
+            local_cycle += costs.pe_issue;
+            msg.timestamp = local_cycle;
+            return true;
+        }
+
+        if (access.active) {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            // The line of an outstanding fill must arrive before the access moves on
+            if (access.awaiting_fill) return false;
+            advanceAccess(costs);
+            continue;
+        }
+
+        if (!instructions.hasInstructions()) {
+            // Write the remaining dirty lines back before finishing
+            if (tagged_cache && flushDirtyLine()) continue;
+            return false;
+        }
+
+        if (!tagged_cache && dependsOnOutstanding(instructions.peekInstruction())) {
+            return false;
+        }
+
+        msg = instructions.nextInstruction();
+        try {
+            prepareMessage(msg, costs);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            continue;
+        }
 
-        if (std::string(e.what()) == "Block index out of range") {
-            if (msg.type == MessageType::BROADCAST_INVALIDATE) {
-                message += r_cache_block1;
-            } else {
-                message += r_cache_block2;
+        if (tagged_cache && (msg.type == MessageType::READ_MEM || msg.type == MessageType::WRITE_MEM)) {
+            beginAccess(std::move(msg));
+            continue;
+        }
+        return true;
+    }
+}
+
+void ProcessingElement::beginAccess(Message&& instruction) {
+    access.active = true;
+    access.is_write = instruction.type == MessageType::WRITE_MEM;
+    access.next_addr = instruction.addr;
+    access.local_word = 0;
+    access.awaiting_fill = false;
+    if (access.is_write) {
+        access.end_addr = instruction.addr + instruction.data.size() * 4;
+        access.store_data = std::move(instruction.data);
+    } else {
+        access.end_addr = instruction.addr + instruction.size * 4;
+        access.store_data.clear();
+    }
+}
+
+void ProcessingElement::advanceAccess(const CycleCosts& costs) {
+    while (access.next_addr < access.end_addr) {
+        uint32_t line = tagged_cache->lineOf(access.next_addr);
+        uint32_t set = tagged_cache->setOf(line);
+        int way = tagged_cache->findWay(line);
+
+        if (way >= 0) {
+            LineState state = tagged_cache->state(set, way);
+            if (!access.is_write || state == LineState::EXCLUSIVE || state == LineState::MODIFIED) {
+                stats.cache_hits++;
+                local_cycle += costs.cache_hit;
+                tagged_cache->touch(set, way);
+                if (state == LineState::EXCLUSIVE && access.is_write) {
+                    stats.silent_upgrades++;
+                }
+                applyLine(set, way);
+                continue;
             }
-        } else if (std::string(e.what()) == "Attempt to read an invalid block") {
-            std::stringstream ss_cache_block;
-            ss_cache_block << "0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (int)block_index;
-
-            message += "\n\treason: Attempt to read an invalid cache block (" + ss_cache_block.str() + ")";
-        } else if (std::string(e.what()) == "Size out of range") {
-            message += r_cache_size;
-        } else if (std::string(e.what()) == "Address out of range") {
-            message += r_addr2;
+
+            // Store to a SHARED/OWNED line: the other copies must be invalidated first
+            stats.cache_misses++;
+            stats.upgrades++;
+            access.awaiting_fill = true;
+            access.fill_request = MessageType::UPGRADE;
+            access.fill_line = line;
+            access.fill_set = set;
+            access.fill_way = way;
+            line_requests.push_back(lineRequest(MessageType::UPGRADE, line));
+            return;
         }
 
-        pes_logger.log(message);
-        throw std::runtime_error("[PE " + std::to_string((int)id) + "]: (Warning) A message was discarded");
+        stats.cache_misses++;
+        uint32_t victim = tagged_cache->chooseVictim(set);
+        if (tagged_cache->isValid(set, victim)) {
+            stats.cache_evictions++;
+            if (tagged_cache->isDirty(set, victim)) {
+                writeBack(set, victim);
+            }
+            setLineState(set, victim, LineState::INVALID);
+        }
+
+        access.awaiting_fill = true;
+        access.fill_request = access.is_write ? MessageType::READ_EXCLUSIVE : MessageType::READ_SHARED;
+        access.fill_line = line;
+        access.fill_set = set;
+        access.fill_way = victim;
+        line_requests.push_back(lineRequest(access.fill_request, line));
+        return;
+    }
+
+    access.active = false;
+    std::cout << "[PE " << (int)id << "]: (Info) " << (access.is_write ? "WRITE_MEM" : "READ_MEM")
+              << " was successful" << std::endl;
+}
+
+void ProcessingElement::applyLine(uint32_t set, uint32_t way) {
+    uint32_t line_start = tagged_cache->lineAt(set, way) * tagged_cache->lineBytes();
+    uint32_t offset = (access.next_addr - line_start) / 4;
+    uint32_t count = std::min((line_start + tagged_cache->lineBytes() - access.next_addr) / 4,
+                              (access.end_addr - access.next_addr) / 4);
+    std::span<uint32_t> line_words = tagged_cache->lineData(set, way).subspan(offset, count);
+
+    if (access.is_write) {
+        std::copy_n(access.store_data.begin() + access.local_word, count, line_words.begin());
+        setLineState(set, way, LineState::MODIFIED);
+    } else {
+        // Loaded words land in the scratchpad, as with an uncached READ_MEM
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t word = access.local_word + i;
+            if (block_directory && (i == 0 || word % config.words_per_block == 0)) {
+                block_directory->addSharer(word / config.words_per_block, id);
+            }
+            cache.writableBlock(word / config.words_per_block)[word % config.words_per_block] = line_words[i];
+        }
     }
 
-    interconnect.enqueueMessage(msg);
+    access.local_word += count;
+    access.next_addr += count * 4;
+}
 
-    auto end = std::chrono::high_resolution_clock::now();
-    double transfer_time = std::chrono::duration<double, std::micro>(end - start).count();    
-    stats.recordSentMessage(calculateMessageSize(msg), transfer_time);
+void ProcessingElement::setLineState(uint32_t set, uint32_t way, LineState state) {
+    stats.recordTransition(tagged_cache->state(set, way), state);
+    tagged_cache->setState(set, way, state);
 }
 
-void ProcessingElement::receiveMessage(const Message& msg) {
-    std::lock_guard<std::mutex> lock(msg_mutex);
+Message ProcessingElement::lineRequest(MessageType type, uint32_t line) {
+    // UPGRADE carries the line size too, in case the line has to be refilled
+    return Message{type, id, INTERCONNECT_ID, line * tagged_cache->lineBytes(), tagged_cache->lineWords(),
+                   0, 0, 0, qos, 0, {}};
+}
+
+void ProcessingElement::writeBack(uint32_t set, uint32_t way) {
+    uint32_t line = tagged_cache->lineAt(set, way);
+    std::span<const uint32_t> words = tagged_cache->lineData(set, way);
+    stats.cache_writebacks++;
+
+    Message msg{MessageType::WRITEBACK, id, INTERCONNECT_ID, line * tagged_cache->lineBytes(), 0, 0, 0, 0, qos, 0, {}};
+    msg.data.setArena(payload_arena);
+    msg.data.append(words);
+    line_requests.push_back(std::move(msg));
+
+    // Until the WRITEBACK is serviced, snoops for the line are answered from here
+    PendingWriteback pending{line, {}, false};
+    pending.data.setArena(payload_arena);
+    pending.data.append(words);
+    pending_writebacks.push_back(std::move(pending));
+}
+
+bool ProcessingElement::flushDirtyLine() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    uint32_t set = 0;
+    uint32_t way = 0;
+    if (!tagged_cache->findDirty(set, way)) return false;
+
+    writeBack(set, way);
+    setLineState(set, way, LineState::INVALID);
+    return true;
+}
+
+void ProcessingElement::handleResponse(Message& resp) {
+    // Fills, upgrades and writebacks were applied when the interconnect serviced them
+    if (tagged_cache && (resp.type == MessageType::READ_RESP || resp.type == MessageType::INV_COMPLETE ||
+                         resp.type == MessageType::WRITE_RESP)) {
+        return;
+    }
+    processResponse(resp);
+}
+
+void ProcessingElement::completeFill(const Message& resp) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    access.awaiting_fill = false;
+
+    // An upgrade whose line was invalidated meanwhile is answered with the data
+    if (resp.type == MessageType::READ_RESP) {
+        LineState granted = LineState::MODIFIED;
+        if (access.fill_request == MessageType::READ_SHARED) {
+            granted = resp.shared ? LineState::SHARED : LineState::EXCLUSIVE;
+        }
+        stats.recordTransition(tagged_cache->state(access.fill_set, access.fill_way), granted);
+        tagged_cache->install(access.fill_set, access.fill_way, access.fill_line, granted);
+        std::span<uint32_t> line_words = tagged_cache->lineData(access.fill_set, access.fill_way);
+        std::copy_n(resp.data.begin(), std::min<size_t>(resp.data.size(), line_words.size()), line_words.begin());
+    } else {
+        setLineState(access.fill_set, access.fill_way, LineState::MODIFIED);
+        tagged_cache->touch(access.fill_set, access.fill_way);
+    }
+    applyLine(access.fill_set, access.fill_way);
+}
+
+SnoopResult ProcessingElement::snoop(uint32_t addr, bool invalidate) {
+    SnoopResult result;
+    if (!tagged_cache) return result;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    uint32_t line = tagged_cache->lineOf(addr);
+
+    for (auto& pending : pending_writebacks) {
+        if (pending.line == line && !pending.flushed) {
+            pending.flushed = true;
+            result.supplied = true;
+            result.from_writeback = true;
+            result.data = std::move(pending.data);
+            stats.snoop_supplies++;
+        }
+    }
+
+    int way = tagged_cache->findWay(line);
+    if (way < 0) return result;
+
+    uint32_t set = tagged_cache->setOf(line);
+    LineState state = tagged_cache->state(set, way);
+    if (state == LineState::OWNED || state == LineState::MODIFIED) {
+        result.supplied = true;
+        result.data.setArena(payload_arena);
+        result.data.append(tagged_cache->lineData(set, way));
+        stats.snoop_supplies++;
+    }
+
+    if (invalidate) {
+        setLineState(set, way, LineState::INVALID);
+        return result;
+    }
+
+    bool keep_owned = config.coherence == CoherenceProtocol::MOESI &&
+                      (state == LineState::OWNED || state == LineState::MODIFIED);
+    setLineState(set, way, keep_owned ? LineState::OWNED : LineState::SHARED);
+    result.keeps_copy = true;
+    return result;
+}
+
+bool ProcessingElement::holdsLine(uint32_t addr) {
+    if (!tagged_cache) return false;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return tagged_cache->findWay(tagged_cache->lineOf(addr)) >= 0;
+}
+
+bool ProcessingElement::retireWriteback(uint32_t addr) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    uint32_t line = tagged_cache->lineOf(addr);
+    for (auto it = pending_writebacks.begin(); it != pending_writebacks.end(); ++it) {
+        if (it->line == line) {
+            bool write_memory = !it->flushed;
+            pending_writebacks.erase(it);
+            return write_memory;
+        }
+    }
+    return true;
+}
+
+MSHR ProcessingElement::footprint(const Message& msg) const {
+    MSHR entry;
+    uint64_t block_bytes = static_cast<uint64_t>(config.words_per_block) * 4;
+    switch (msg.type) {
+        case MessageType::READ_MEM:
+            entry.mem_begin = msg.addr;
+            entry.mem_end = msg.addr + static_cast<uint64_t>(msg.size) * 4;
+            entry.writes_blocks = true;
+            entry.block_begin = 0;
+            entry.block_end = (static_cast<uint64_t>(msg.size) + config.words_per_block - 1) / config.words_per_block;
+            break;
+        case MessageType::WRITE_MEM:
+            entry.writes_memory = true;
+            entry.mem_begin = msg.addr;
+            entry.mem_end = msg.addr + static_cast<uint64_t>(msg.num_of_cache_lines) * block_bytes;
+            entry.block_begin = msg.start_cache_line;
+            entry.block_end = static_cast<uint64_t>(msg.start_cache_line) + msg.num_of_cache_lines;
+            break;
+        case MessageType::BROADCAST_INVALIDATE:
+            // Other PEs drop their copy: keep it ordered with this PE's writes
+            entry.mem_begin = 0;
+            entry.mem_end = UINT64_MAX;
+            break;
+        default:
+            break;
+    }
+    return entry;
+}
+
+bool ProcessingElement::dependsOnOutstanding(const Message& instruction) const {
+    if (outstanding == 0) return false;
+
+    MSHR next = footprint(instruction);
+    for (const auto& entry : mshrs) {
+        if (!entry.busy) continue;
+
+        bool memory_overlap = next.mem_begin < entry.mem_end && entry.mem_begin < next.mem_end;
+        if (memory_overlap && (next.writes_memory || entry.writes_memory)) return true;
+
+        bool block_overlap = next.block_begin < entry.block_end && entry.block_begin < next.block_end;
+        if (block_overlap && entry.writes_blocks) return true;
+    }
+    return false;
+}
+
+void ProcessingElement::accountOutstanding() {
+    if (outstanding > 0 && local_cycle > last_mshr_change) {
+        stats.memory_busy_cycles += local_cycle - last_mshr_change;
+    }
+    last_mshr_change = std::max(last_mshr_change, local_cycle);
+}
+
+void ProcessingElement::trackRequest(Message& msg) {
+    accountOutstanding();
+
+    msg.req_id = next_req_id++;
+    for (auto& entry : mshrs) {
+        if (entry.busy) continue;
+
+        entry = tagged_cache ? MSHR{} : footprint(msg);
+        entry.busy = true;
+        entry.req_id = msg.req_id;
+        entry.issue_cycle = msg.timestamp;
+        break;
+    }
+    outstanding++;
+    stats.max_outstanding = std::max(stats.max_outstanding, outstanding);
+}
+
+void ProcessingElement::retireRequest(const Message& resp) {
+    accountOutstanding();
+
+    for (auto& entry : mshrs) {
+        if (entry.busy && entry.req_id == resp.req_id) {
+            entry.busy = false;
+            outstanding--;
+            stats.completed_requests++;
+            stats.request_latency_cycles += local_cycle - std::min(local_cycle, entry.issue_cycle);
+            if (tracer.sampled(resp.req_id)) {
+                uint64_t request = Tracer::requestId(id, resp.req_id);
+                tracer.record({request, entry.issue_cycle, local_cycle, TraceStage::REQUEST, resp.type, 0});
+                tracer.record({request, resp.timestamp, local_cycle, TraceStage::PE_WAIT, resp.type, 0});
+            }
+            return;
+        }
+    }
+    std::cerr << "[PE " << (int)id << "]: (Warning) Response to unknown request " << resp.req_id << std::endl;
+}
+
+bool ProcessingElement::issueNext(Message& msg, const CycleCosts& costs) {
+    if (!nextRequest(msg, costs)) return false;
+
+    trackRequest(msg);
+    stats.recordSentMessage(calculateMessageSize(msg), 0.0);
+    return true;
+}
+
+bool ProcessingElement::canIssue() const {
+    if (outstanding >= mshrs.size()) return false;
+    if (tagged_cache) return hasWork();
+    return instructions.hasInstructions() && !dependsOnOutstanding(instructions.peekInstruction());
+}
+
+bool ProcessingElement::isDone() const {
+    return outstanding == 0 && !hasWork();
+}
+
+uint64_t ProcessingElement::localCycle() const {
+    return local_cycle;
+}
+
+void ProcessingElement::completeResponse(Message& resp) {
     stats.recordReceivedMessage();
-    incoming_messages.push(msg);
-    msg_cv.notify_one(); // Notify waiting thread that a message is available
+    stallUntil(resp.timestamp);
+    retireRequest(resp);
+    handleResponse(resp);
+}
+
+void ProcessingElement::stallUntil(uint64_t cycle) {
+    if (cycle > local_cycle) {
+        stats.recordStall(cycle - local_cycle);
+        local_cycle = cycle;
+    }
+}
+
+void ProcessingElement::finish() {
+    stats.finish_cycle = local_cycle;
+}
+
+bool ProcessingElement::hasWork() const {
+    if (instructions.hasInstructions() || access.active || !line_requests.empty()) return true;
+    if (!tagged_cache) return false;
+    // Snoops downgrade dirty lines from the interconnect thread
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return tagged_cache->hasDirtyLines();
 }
 
-void ProcessingElement::invalidateCacheBlock(uint8_t cache_line) {
+void ProcessingElement::invalidateCacheBlock(uint32_t cache_line) {
     cache.invalidateBlock(cache_line);
 }
 
@@ -184,27 +608,15 @@ void ProcessingElement::processResponse(Message& msg) {
             }
             std::cout << "[PE " << (int)id << "]: (Info) READ_MEM was successful" << std::endl;
 
-            if (msg.data.size() == 4) {
-                cache.writeBlock(0, msg.data);
-                break;
-            }
-
-            u_int8_t block_index = 0;
-            u_int8_t word_offset = 0;
-            while (!msg.data.empty()) {
-                uint32_t word = msg.data.front();
-                msg.data.erase(msg.data.begin());
-
-                if (word_offset < WORDS_PER_BLOCK) {
-                    cache.writeWord(block_index, word_offset, word);
-                    word_offset++;
-                } 
-                else {
-                    word_offset = 0;
-                    block_index++;
-                    cache.writeWord(block_index, word_offset, word);
-                    word_offset++;
+            // Copy the words block by block, starting at block 0
+            std::span<const uint32_t> words = msg.data;
+            for (uint32_t block_index = 0; !words.empty(); block_index++) {
+                size_t chunk = std::min<size_t>(words.size(), config.words_per_block);
+                if (block_directory) {
+                    block_directory->addSharer(block_index, id); // Before the block turns valid
                 }
+                std::copy_n(words.begin(), chunk, cache.writableBlock(block_index).begin());
+                words = words.subspan(chunk);
             }
             break;
         }
@@ -230,31 +642,48 @@ void ProcessingElement::processResponse(Message& msg) {
 void ProcessingElement::process(Interconnect& interconnect) {
     stats.startActivePeriod(); // PE starts in active state
 
-    while (instructions.hasInstructions()) {
-        Message msg = instructions.nextInstruction();
+    while (true) {
+        // Active period - send every request the free MSHRs allow
+        while (canIssue()) {
+            auto start = std::chrono::high_resolution_clock::now();
 
-        // Active period - sending message
-        try {
-            sendMessage(msg, interconnect);
-        } catch (const std::exception& e) {
-            std::cerr << e.what() << std::endl;
-            continue;
+            Message msg;
+            if (!nextRequest(msg, interconnect.getCycleCosts())) break;
+            trackRequest(msg);
+            size_t msg_size = calculateMessageSize(msg);
+            interconnect.enqueueMessage(std::move(msg));
+
+            auto end = std::chrono::high_resolution_clock::now();
+            double transfer_time = std::chrono::duration<double, std::micro>(end - start).count();
+            stats.recordSentMessage(msg_size, transfer_time);
         }
+        if (isDone()) break;
 
         // Transition to inactive while waiting
         stats.startInactivePeriod();
 
-        // Blocking wait for the response
+        // Blocking wait for at least one response
         std::unique_lock<std::mutex> lock(msg_mutex);
         msg_cv.wait(lock, [this] { return !incoming_messages.empty(); });
 
-        // Transition back to active when processing response
+        // Transition back to active when processing responses
         stats.startActivePeriod();
-        
-        Message resp = incoming_messages.front();
-        incoming_messages.pop();
-        processResponse(resp);
+
+        std::queue<Message> responses;
+        responses.swap(incoming_messages);
+        lock.unlock();
+
+        while (!responses.empty()) {
+            Message resp = std::move(responses.front());
+            responses.pop();
+
+            // Stall the local clock until the response completes
+            stallUntil(resp.timestamp);
+            retireRequest(resp);
+            handleResponse(resp);
+        }
     }
 
+    finish();
     stats.finalizeTiming(); // Final time accounting
 }
@@ -1,13 +1,22 @@
 #ifndef PROCESSING_ELEMENT_HPP
 #define PROCESSING_ELEMENT_HPP
 
+#include <cmath>
 #include <iostream>
 #include <queue>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include "cache_memory.hpp"
+#include "directory.hpp"
+#include "histogram.hpp"
 #include "instruction_memory.hpp"
 #include "message.hpp"
+#include "set_associative_cache.hpp"
+#include "sim_clock.hpp"
+#include "system_config.hpp"
+#include "traffic_generator.hpp"
 #include "utils.hpp"
 
 // Forward declaration
@@ -30,8 +39,39 @@ struct PEStats {
     size_t discarded_msgs = 0;   // Failed messages (alignment/size errors, etc)
 
     // Timing and size data
-    std::vector<double> message_transfer_times; // In microseconds
-    std::vector<size_t> message_sizes;          // In bytes
+    Histogram transfer_times_ns;  // Host time to hand each message to the interconnect
+    Histogram message_sizes;      // In bytes
+
+    // Simulated time (cycles)
+    uint64_t finish_cycle = 0;   // Local virtual clock after the last instruction
+    uint64_t stall_cycles = 0;   // Cycles spent waiting for responses
+
+    // Set-associative cache (line accesses)
+    bool tagged_cache = false;   // Set-associative cache mode enabled
+    size_t cache_hits = 0;
+    size_t cache_misses = 0;     // Includes upgrades of SHARED/OWNED lines
+    size_t cache_evictions = 0;  // Valid lines replaced
+    size_t cache_writebacks = 0; // Dirty lines written to shared memory
+
+    // Coherence
+    CoherenceProtocol protocol = CoherenceProtocol::MESI;
+    size_t upgrades = 0;         // Stores that needed an UPGRADE
+    size_t silent_upgrades = 0;  // Stores to EXCLUSIVE lines (no bus transaction)
+    size_t snoop_supplies = 0;   // Dirty lines handed to another cache
+    size_t transitions[NUM_LINE_STATES][NUM_LINE_STATES] = {}; // [from][to]
+
+    // Outstanding requests (MSHRs)
+    uint32_t mshrs = DEFAULT_MSHRS;
+    uint32_t max_outstanding = 0;
+    size_t completed_requests = 0;
+    uint64_t request_latency_cycles = 0; // Sum of issue-to-response cycles
+    uint64_t memory_busy_cycles = 0;     // Cycles with at least one request in flight
+
+    void recordTransition(LineState from, LineState to) {
+        if (from != to) {
+            transitions[static_cast<size_t>(from)][static_cast<size_t>(to)]++;
+        }
+    }
 
     // Timing metrics
     std::chrono::microseconds active_time{0};
@@ -42,14 +82,19 @@ struct PEStats {
     void recordSentMessage(size_t size, double transfer_time) {
         total_msgs++;
         sent_msgs++;
-        message_sizes.push_back(size);
-        message_transfer_times.push_back(transfer_time);
+        message_sizes.record(size);
+        // Kept in nanoseconds so that sub-microsecond transfers still spread over the buckets
+        transfer_times_ns.record(static_cast<uint64_t>(std::llround(transfer_time * 1000.0)));
     }
 
     void recordReceivedMessage() {
         received_msgs++;
     }
 
+    void recordStall(uint64_t cycles) {
+        stall_cycles += cycles;
+    }
+
     void recordDiscardedMessage() {
         total_msgs++;
         discarded_msgs++;
@@ -81,23 +126,32 @@ struct PEStats {
         }
     }
 
-    std::string getSummary(uint8_t id) const {
+    std::string getSummary(uint16_t id) const {
         // Calculate averages
-        double avg_transfer_time = message_transfer_times.empty() ? 0.0 :
-            std::accumulate(message_transfer_times.begin(), 
-                          message_transfer_times.end(), 0.0) 
-            / message_transfer_times.size();
-
-        double avg_msg_size = message_sizes.empty() ? 0.0 :
-            std::accumulate(message_sizes.begin(), 
-                          message_sizes.end(), 0.0) 
-            / message_sizes.size();
-
         // Calculate time percentages
         double total_time = (active_time + inactive_time).count();
         double active_percent = total_time > 0 ? 
             (100.0 * active_time.count() / total_time) : 0.0;
         double inactive_percent = 100.0 - active_percent;
+        double stall_percent = finish_cycle > 0 ?
+            (100.0 * stall_cycles / finish_cycle) : 0.0;
+
+        size_t line_accesses = cache_hits + cache_misses;
+        double hit_rate = line_accesses > 0 ? (100.0 * cache_hits / line_accesses) : 0.0;
+        double miss_rate = line_accesses > 0 ? (100.0 * cache_misses / line_accesses) : 0.0;
+
+        // Memory-level parallelism: requests in flight while any is in flight
+        double mlp = memory_busy_cycles > 0 ? static_cast<double>(request_latency_cycles) / memory_busy_cycles : 0.0;
+        double mean_request_latency = completed_requests > 0 ?
+            static_cast<double>(request_latency_cycles) / completed_requests : 0.0;
+        double requests_per_kcycle = finish_cycle > 0 ? 1000.0 * completed_requests / finish_cycle : 0.0;
+        // A blocking PE would also have waited the cycles the MSHRs overlapped
+        uint64_t overlapped_cycles = request_latency_cycles - std::min(request_latency_cycles, memory_busy_cycles);
+        double throughput_gain = finish_cycle > 0 ?
+            static_cast<double>(finish_cycle + overlapped_cycles) / finish_cycle : 1.0;
+
+        // Transfer times are recorded in nanoseconds and shown in microseconds
+        auto transfer_us = [](uint64_t ns) { return ns / 1000.0; };
 
         // Format output
         std::stringstream ss;
@@ -110,19 +164,54 @@ struct PEStats {
                   << "  Discarded:         " << discarded_msgs 
                   << " (" << (100.0*discarded_msgs/total_msgs) << "%)\n\n"
                   << "Transfer Times (μs):\n"
-                  << "  Average:           " << avg_transfer_time << "\n"
-                  << "  Min:               " 
-                  << *std::min_element(message_transfer_times.begin(), 
-                                     message_transfer_times.end()) << "\n"
-                  << "  Max:               " 
-                  << *std::max_element(message_transfer_times.begin(), 
-                                     message_transfer_times.end()) << "\n\n"
+                  << "  Average:           " << transfer_times_ns.mean() / 1000.0 << "\n"
+                  << "  Min:               " << transfer_us(transfer_times_ns.min()) << "\n"
+                  << "  p50:               " << transfer_us(transfer_times_ns.percentile(0.50)) << "\n"
+                  << "  p90:               " << transfer_us(transfer_times_ns.percentile(0.90)) << "\n"
+                  << "  p99:               " << transfer_us(transfer_times_ns.percentile(0.99)) << "\n"
+                  << "  p99.9:             " << transfer_us(transfer_times_ns.percentile(0.999)) << "\n"
+                  << "  Max:               " << transfer_us(transfer_times_ns.max()) << "\n\n"
                   << "Message Sizes (bytes):\n"
-                  << "  Average:           " << avg_msg_size << "\n"
-                  << "  Total:             " 
-                  << std::accumulate(message_sizes.begin(), 
-                                    message_sizes.end(), 0) << "\n"
-                  << "\nTime Analysis (μs):\n"
+                  << "  Average:           " << message_sizes.mean() << "\n"
+                  << "  p50:               " << message_sizes.percentile(0.50) << "\n"
+                  << "  p99:               " << message_sizes.percentile(0.99) << "\n"
+                  << "  Max:               " << message_sizes.max() << "\n"
+                  << "  Total:             " << message_sizes.sum() << "\n"
+                  << "\nSimulated Time (cycles):\n"
+                  << "  Finish Cycle:      " << finish_cycle << "\n"
+                  << "  Stall Cycles:      " << stall_cycles
+                  << " (" << stall_percent << "%)\n"
+                  << "\nMemory-Level Parallelism:\n"
+                  << "  MSHRs:             " << mshrs << "\n"
+                  << "  Peak In Flight:    " << max_outstanding << "\n"
+                  << "  MLP:               " << mlp << "\n"
+                  << "  Request Latency:   " << mean_request_latency << " cycles\n"
+                  << "  Requests/kcycle:   " << requests_per_kcycle << "\n"
+                  << "  Overlapped Cycles: " << overlapped_cycles << "\n"
+                  << "  Throughput Gain:   " << throughput_gain << "x (vs. blocking)\n";
+        if (tagged_cache) {
+            ss << "\nSet-Associative Cache (lines):\n"
+               << "  Hits:              " << cache_hits << "\n"
+               << "  Misses:            " << cache_misses << "\n"
+               << "  Hit Rate:          " << hit_rate << "%\n"
+               << "  Miss Rate:         " << miss_rate << "%\n"
+               << "  Evictions:         " << cache_evictions << "\n"
+               << "  Writebacks:        " << cache_writebacks << "\n"
+               << "\nCoherence (" << coherenceProtocolName(protocol) << "):\n"
+               << "  Upgrades:          " << upgrades << "\n"
+               << "  Silent Upgrades:   " << silent_upgrades << "\n"
+               << "  Snoop Supplies:    " << snoop_supplies << "\n"
+               << "  Transitions:\n";
+            for (size_t from = 0; from < NUM_LINE_STATES; from++) {
+                for (size_t to = 0; to < NUM_LINE_STATES; to++) {
+                    if (transitions[from][to] == 0) continue;
+                    ss << "    " << lineStateName(static_cast<LineState>(from)) << " -> "
+                       << lineStateName(static_cast<LineState>(to)) << ":          "
+                       << transitions[from][to] << "\n";
+                }
+            }
+        }
+        ss << "\nTime Analysis (μs):\n"
                   << "  Active:            " << active_time.count() 
                   << " (" << active_percent << "%)\n"
                   << "  Inactive:          " << inactive_time.count()
@@ -134,6 +223,56 @@ struct PEStats {
     }
 };
 
+/**
+ * @brief Answer of a PE to a coherence snoop from the interconnect.
+ */
+struct SnoopResult {
+    bool keeps_copy = false;        // The line is still valid in the PE after the snoop
+    bool supplied = false;          // The PE held the only up-to-date copy and returned it
+    bool from_writeback = false;    // The supplied data came from a writeback not yet serviced
+    Payload data;                   // Line contents when supplied
+};
+
+/**
+ * @brief Miss-status holding register: one request of the PE in flight.
+ *
+ * Records the shared memory bytes and scratchpad blocks the request touches,
+ * so that later instructions depending on it wait for its response.
+ */
+struct MSHR {
+    bool busy = false;
+    uint32_t req_id = 0;
+    uint64_t issue_cycle = 0;
+    bool writes_memory = false;     // WRITE_MEM/WRITEBACK
+    bool writes_blocks = false;     // READ_MEM fills scratchpad blocks when it completes
+    uint64_t mem_begin = 0;         // Shared memory bytes [mem_begin, mem_end)
+    uint64_t mem_end = 0;
+    uint64_t block_begin = 0;       // Scratchpad blocks [block_begin, block_end)
+    uint64_t block_end = 0;
+};
+
+/**
+ * @brief Progress of a READ_MEM/WRITE_MEM served through the set-associative cache.
+ *
+ * The access walks its address range line by line; hits are served locally
+ * and a miss pauses the walk until the line fill returns.
+ */
+struct MemoryAccess {
+    bool active = false;
+    bool is_write = false;
+    uint32_t next_addr = 0;     // Byte address of the next word to serve
+    uint32_t end_addr = 0;      // Byte address past the last word
+    uint32_t local_word = 0;    // Scratchpad word (READ_MEM) or store word (WRITE_MEM) of next_addr
+    Payload store_data;         // Words stored by a WRITE_MEM
+
+    // Outstanding line fill or upgrade
+    bool awaiting_fill = false; // Set until completeFill installs the line; no other line is requested meanwhile
+    MessageType fill_request = MessageType::READ_SHARED;
+    uint32_t fill_line = 0;
+    uint32_t fill_set = 0;
+    uint32_t fill_way = 0;
+};
+
 /**
  * @brief Class representing a processing element in a multi-core system.
  *
@@ -142,24 +281,158 @@ struct PEStats {
  */
 class ProcessingElement {
 private:
-    static uint8_t next_id;                 // Static counter for automatic ID assignment
-    uint8_t id;                             // ID of the PE
+    static uint16_t next_id;                // Static counter for automatic ID assignment
+    uint16_t id;                            // ID of the PE
     uint8_t qos;                            // Priority of the PE (e.g. 0x00-0xFF)
-    CacheMemory cache;                      // 128 blocks * 16 bytes = 2048 bytes
+    SystemConfig config;                    // Sizes of the simulated system
+    CacheMemory cache;                      // cache_blocks * words_per_block words (2048 bytes by default)
     InstructionMemory instructions;         // Workload of the PE
     std::queue<Message> incoming_messages;  // Messages received
     std::mutex msg_mutex;                   // Mutex for protecting incoming messages queue
     std::condition_variable msg_cv;         // Condition variable for signaling new messages
     PEStats stats;                          // Stats of the PE
+    uint64_t local_cycle = 0;               // Local virtual clock of the PE
+    PayloadArena* payload_arena = nullptr;  // Storage for payloads longer than a few words
+    Directory* block_directory = nullptr;   // Holders of each cache block (null when invalidations are broadcast)
+
+    // Set-associative cache mode
+    std::unique_ptr<SetAssociativeCache> tagged_cache; // Null in scratchpad mode
+    MemoryAccess access;                    // READ_MEM/WRITE_MEM being served by the cache
+    std::deque<Message> line_requests;      // Writebacks and fills waiting to be issued
+    mutable std::mutex cache_mutex;         // Guards the tagged cache against interconnect snoops
+
+    /**
+     * @brief Dirty line evicted from the tagged cache whose WRITEBACK is not serviced yet.
+     */
+    struct PendingWriteback {
+        uint32_t line;
+        Payload data;
+        bool flushed;                       // A snoop already sent the data to memory
+    };
+    std::vector<PendingWriteback> pending_writebacks;
+
+    // Requests in flight
+    std::vector<MSHR> mshrs;                // config.mshrs registers
+    uint32_t outstanding = 0;               // Busy MSHRs
+    uint32_t next_req_id = 0;               // ID of the next request
+    uint64_t last_mshr_change = 0;          // Local cycle of the last issue or retirement
+
+    /**
+     * @brief Describes the memory bytes and scratchpad blocks an instruction touches.
+     */
+    MSHR footprint(const Message& msg) const;
+
+    /**
+     * @brief Checks whether an instruction must wait for a request in flight.
+     *
+     * It must wait if both touch the same memory bytes and one of them writes
+     * memory, or if it touches scratchpad blocks a READ_MEM in flight will fill.
+     */
+    bool dependsOnOutstanding(const Message& instruction) const;
+
+    /**
+     * @brief Accounts the cycles since the last MSHR change as memory busy time.
+     */
+    void accountOutstanding();
+
+    /**
+     * @brief Gives a request its ID and records it in a free MSHR.
+     */
+    void trackRequest(Message& msg);
+
+    /**
+     * @brief Frees the MSHR of the request a response answers.
+     */
+    void retireRequest(const Message& resp);
+
+    /**
+     * @brief Advances the local clock to a later cycle, counting the stall.
+     *
+     * @param cycle Cycle to wait for.
+     */
+    void stallUntil(uint64_t cycle);
+
+    /**
+     * @brief Produces the next request for the interconnect.
+     *
+     * In scratchpad mode every valid instruction is a request. In
+     * set-associative mode READ_MEM/WRITE_MEM are served by the cache and
+     * only line fills and writebacks (including the final flush) leave the PE.
+     *
+     * @param msg Destination of the request.
+     * @param costs Cycle costs used to advance the local clock.
+     * @return True if a request was produced, false if the PE has no work left
+     *         or its next instruction depends on a request in flight.
+     */
+    bool nextRequest(Message& msg, const CycleCosts& costs);
+
+    /**
+     * @brief Starts serving a prepared READ_MEM/WRITE_MEM through the cache.
+     */
+    void beginAccess(Message&& instruction);
+
+    /**
+     * @brief Serves lines of the current access until one misses or the access ends.
+     *
+     * A miss queues the writeback of a dirty victim and the fill of the missing
+     * line. A store fills with READ_EXCLUSIVE even when it overwrites the whole
+     * line, because the other copies must be invalidated. A store to a
+     * SHARED/OWNED line queues an UPGRADE instead.
+     */
+    void advanceAccess(const CycleCosts& costs);
+
+    /**
+     * @brief Moves the words of the current access that fall in a cached line.
+     */
+    void applyLine(uint32_t set, uint32_t way);
+
+    /**
+     * @brief Builds a line-sized request to the interconnect.
+     *
+     * @param type READ_SHARED, READ_EXCLUSIVE or UPGRADE.
+     * @param line Line address.
+     */
+    Message lineRequest(MessageType type, uint32_t line);
+
+    /**
+     * @brief Evicts a dirty line: queues its WRITEBACK and keeps the data for snoops.
+     */
+    void writeBack(uint32_t set, uint32_t way);
+
+    /**
+     * @brief Changes the state of a line and counts the transition.
+     */
+    void setLineState(uint32_t set, uint32_t way, LineState state);
+
+    /**
+     * @brief Queues the writeback of one dirty line and invalidates it.
+     *
+     * @return True if a dirty line was found.
+     */
+    bool flushDirtyLine();
+
+    /**
+     * @brief Passes a response to processResponse unless the tagged cache already applied it.
+     */
+    void handleResponse(Message& resp);
 
 public:
     /**
      * @brief Constructor for the ProcessingElement class.
      *
-     * @param id_  The ID of the processing element.
      * @param qos_ The QoS (priority) of the processing element.
+     * @param config_ Sizes of the simulated system (cache geometry, memory size).
      */
-    ProcessingElement(uint8_t qos_) : id(next_id++), qos(qos_) {
+    ProcessingElement(uint8_t qos_, const SystemConfig& config_ = SystemConfig())
+        : id(next_id++), qos(qos_), config(config_), cache(config_.cache_blocks, config_.words_per_block) {
+        if (config.cache_mode == CacheMode::SET_ASSOCIATIVE) {
+            tagged_cache = std::make_unique<SetAssociativeCache>(
+                config.cache_sets, config.cache_ways, config.line_words, config.replacement);
+            stats.tagged_cache = true;
+            stats.protocol = config.coherence;
+        }
+        mshrs.resize(config.mshrs);
+        stats.mshrs = config.mshrs;
         setReasons();
     }
 
@@ -173,7 +446,13 @@ public:
      *
      * @return The ID of the processing element.
      */
-    uint8_t getID();
+    uint16_t getID();
+
+    /**
+     * @brief Restarts automatic ID assignment at 0, so a new system can be built
+     *        in the same process (IDs index the PEs registered with an interconnect).
+     */
+    static void resetIDs();
 
     /**
      * @brief Gets the QoS of the processing element.
@@ -196,6 +475,20 @@ public:
      */
     void setCache(uint32_t seed);
 
+    /**
+     * @brief Sets the arena used for the payloads of outgoing messages.
+     *
+     * @param arena Arena of the simulated system (owned by the interconnect).
+     */
+    void setPayloadArena(PayloadArena* arena);
+
+    /**
+     * @brief Sets the directory where the PE registers the cache blocks it fills.
+     *
+     * @param directory Block directory of the interconnect, or null when invalidations are broadcast.
+     */
+    void setBlockDirectory(Directory* directory);
+
     /**
      * @brief Loads cache contents from a file.
      * 
@@ -213,6 +506,18 @@ public:
      */
     bool loadInstructions(const std::string& filename);
 
+    /**
+     * @brief Gets the number of compiled workload records skipped for having an unknown type.
+     */
+    size_t getRejectedInstructions() const;
+
+    /**
+     * @brief Appends a synthetic instruction stream, generated as the PE runs.
+     *
+     * @param traffic Pattern, mix, length and seed of the stream.
+     */
+    void generateInstructions(const TrafficConfig& traffic);
+
     /**
      * @brief Saves cache contents to a file.
      * 
@@ -227,32 +532,118 @@ public:
     void saveStats();
 
     /**
-     * @brief Sends a message to the interconnect.
+     * @brief Validates a message and fills it before it leaves the PE.
      *
-     * This method sets the source and QoS of the message, performs necessary
-     * data processing based on the message type, and enqueues the message
-     * into the interconnect.
+     * Sets the source, QoS and issue cycle of the message and copies the
+     * cache blocks of a WRITE_MEM into its data. Invalid messages are logged
+     * as discarded.
      *
-     * @param msg The message to send.
-     * @param interconnect The interconnect to send the message to.
-     * @throws std::runtime_error If the address is not aligned to 4 bytes.
-     * @throws std::out_of_range If the size or block index is out of range.
+     * @param msg The message to prepare.
+     * @param costs Cycle costs used to advance the local clock.
+     * @throws std::runtime_error If the message was discarded.
      */
-    void sendMessage(Message& msg, Interconnect& interconnect);
+    void prepareMessage(Message& msg, const CycleCosts& costs);
 
     /**
      * @brief Receives a message and adds it to the incoming message queue.
      *
-     * @param msg The message to receive.
+     * @param msg The message to receive (ownership is transferred to the PE).
+     */
+    void receiveMessage(Message&& msg);
+
+    /**
+     * @brief Prepares the next request without sending it.
+     *
+     * Used by the discrete-event engine, which decides when the message
+     * reaches the interconnect. Discarded instructions are skipped and, in
+     * set-associative mode, cache hits are served without a request.
+     *
+     * @param msg Destination of the prepared message.
+     * @param costs Cycle costs used to advance the local clock.
+     * @return True if a message was prepared, false if nothing can be issued now.
+     */
+    bool issueNext(Message& msg, const CycleCosts& costs);
+
+    /**
+     * @brief Checks whether the PE could issue a request now (a free MSHR and an independent instruction).
+     */
+    bool canIssue() const;
+
+    /**
+     * @brief Checks whether the PE has finished: no work left and nothing in flight.
+     */
+    bool isDone() const;
+
+    /**
+     * @brief Gets the local virtual clock of the PE.
+     */
+    uint64_t localCycle() const;
+
+    /**
+     * @brief Accepts a response delivered by the discrete-event engine.
+     *
+     * Stalls the local clock until the response completes and processes it.
+     *
+     * @param resp The response message.
+     */
+    void completeResponse(Message& resp);
+
+    /**
+     * @brief Records the final simulated cycle of the PE.
+     */
+    void finish();
+
+    /**
+     * @brief Applies a coherence request of another PE to the tagged cache.
+     *
+     * Called by the interconnect while it services the request. A read
+     * downgrades the line to SHARED (OWNED under MOESI when it was dirty);
+     * an invalidating request drops it. Dirty data, including data waiting in
+     * an unserviced writeback, is returned to the caller.
+     *
+     * @param addr Byte address inside the line.
+     * @param invalidate True for READ_EXCLUSIVE/UPGRADE, false for READ_SHARED.
+     * @return What the PE held and, if dirty, the line contents.
+     */
+    SnoopResult snoop(uint32_t addr, bool invalidate);
+
+    /**
+     * @brief Installs the line of a coherent fill or upgrade and continues the access with it.
+     *
+     * Called by the interconnect when it services the request, so the line
+     * states of every cache follow the order in which requests were
+     * serialized; the response delivered later only advances the PE clock.
+     *
+     * @param resp READ_RESP (fill) or INV_COMPLETE (upgrade) for this PE.
+     */
+    void completeFill(const Message& resp);
+
+    /**
+     * @brief Checks whether the tagged cache still holds a line.
+     */
+    bool holdsLine(uint32_t addr);
+
+    /**
+     * @brief Retires the pending writeback of a line when its WRITEBACK is serviced.
+     *
+     * @param addr Byte address of the line.
+     * @return True if memory must be written, false if a snoop already flushed the data.
+     */
+    bool retireWriteback(uint32_t addr);
+
+    /**
+     * @brief Checks if the PE has work left (instructions, a cache access or dirty lines).
+     *
+     * @return True if there is more work, false otherwise.
      */
-    void receiveMessage(const Message& msg);
+    bool hasWork() const;
 
     /**
      * @brief Invalidates a cache block in the cache memory.
      *
      * @param cache_line The index of the cache line to invalidate.
      */
-    void invalidateCacheBlock(uint8_t cache_line);
+    void invalidateCacheBlock(uint32_t cache_line);
 
     /**
      * @brief Processes a response message.
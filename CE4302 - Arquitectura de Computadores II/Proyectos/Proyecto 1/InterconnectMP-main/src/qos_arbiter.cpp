@@ -0,0 +1,78 @@
+#include <bit>
+#include "qos_arbiter.hpp"
+
+int QoSArbiter::highestBelow(int bound) const {
+    for (int word = (bound - 1) / 64; word >= 0; word--) {
+        uint64_t bits = occupied[word];
+        int top_bit = bound - word * 64;            // Bits of this word below the bound
+        if (top_bit < 64) {
+            bits &= (uint64_t{1} << top_bit) - 1;
+        }
+        if (bits != 0) {
+            return word * 64 + 63 - std::countl_zero(bits);
+        }
+    }
+    return NONE;
+}
+
+uint64_t QoSArbiter::effectiveLevel(int level, uint64_t now) const {
+    uint64_t issued = nodes[buckets[level].head].msg.timestamp;
+    uint64_t waited = now > issued ? now - issued : 0;
+    return level + waited / aging_cycles;
+}
+
+void QoSArbiter::push(Message&& msg) {
+    int32_t index = free_nodes;
+    if (index != NONE) {
+        free_nodes = nodes[index].next;
+        nodes[index].msg = std::move(msg);
+        nodes[index].next = NONE;
+    } else {
+        index = static_cast<int32_t>(nodes.size());
+        nodes.push_back(Node{std::move(msg), NONE});
+    }
+
+    uint8_t level = nodes[index].msg.qos;
+    Bucket& bucket = buckets[level];
+    if (bucket.tail == NONE) {
+        bucket.head = index;
+        occupied[level / 64] |= uint64_t{1} << (level % 64);
+    } else {
+        nodes[bucket.tail].next = index;
+    }
+    bucket.tail = index;
+    count++;
+}
+
+Message QoSArbiter::pop(uint64_t now) {
+    int level = highestBelow(NUM_QOS_LEVELS);
+
+    if (aging_cycles > 0) {
+        int top = level;
+        uint64_t best = effectiveLevel(top, now);
+        for (int lower = highestBelow(top); lower != NONE; lower = highestBelow(lower)) {
+            uint64_t effective = effectiveLevel(lower, now);
+            if (effective > best) {
+                best = effective;
+                level = lower;
+            }
+        }
+        if (level != top) {
+            aged_picks++;
+        }
+    }
+
+    Bucket& bucket = buckets[level];
+    int32_t index = bucket.head;
+    bucket.head = nodes[index].next;
+    if (bucket.head == NONE) {
+        bucket.tail = NONE;
+        occupied[level / 64] &= ~(uint64_t{1} << (level % 64));
+    }
+
+    Message msg = std::move(nodes[index].msg);
+    nodes[index].next = free_nodes;
+    free_nodes = index;
+    count--;
+    return msg;
+}
@@ -0,0 +1,81 @@
+#ifndef QOS_ARBITER_HPP
+#define QOS_ARBITER_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "arbiter.hpp"
+
+/**
+ * @brief Priority arbiter with one FIFO bucket per QoS level.
+ *
+ * A bitmap marks the non-empty buckets, so the highest level is found with
+ * a find-first-set over four 64-bit words; messages of the same level leave
+ * in arrival order. Messages are moved once into a pooled node and linked
+ * into their bucket, so push and pop never touch the other messages.
+ *
+ * With aging enabled, the head of a bucket gains one level for every
+ * aging period it has waited, and the pick goes to the highest effective
+ * level (ties to the higher QoS), so low-QoS PEs cannot starve.
+ */
+class QoSArbiter : public Arbiter {
+private:
+    static constexpr int32_t NONE = -1;
+
+    struct Node {
+        Message msg;
+        int32_t next = NONE;                // Next node of the bucket, or of the free list
+    };
+
+    struct Bucket {
+        int32_t head = NONE;                // Oldest message of the level
+        int32_t tail = NONE;                // Newest message of the level
+    };
+
+    std::vector<Node> nodes;                            // Node pool
+    int32_t free_nodes = NONE;                          // Free list of the pool
+    std::array<Bucket, NUM_QOS_LEVELS> buckets;
+    std::array<uint64_t, NUM_QOS_LEVELS / 64> occupied{}; // Bit per non-empty bucket
+    size_t count = 0;                                   // Queued messages
+    uint64_t aging_cycles = 0;                          // Wait per level gained (0: strict priority)
+    uint64_t aged_picks = 0;                            // Picks that aging took from a higher level
+
+    /**
+     * @brief Gets the highest non-empty level below a bound, or NONE.
+     */
+    int highestBelow(int bound) const;
+
+    /**
+     * @brief Gets the level of the head of a bucket after aging.
+     */
+    uint64_t effectiveLevel(int level, uint64_t now) const;
+
+public:
+    /**
+     * @brief Enables aging.
+     *
+     * @param cycles Waiting cycles that raise a message by one level (0 disables aging).
+     */
+    void setAging(uint64_t cycles) { aging_cycles = cycles; }
+
+    /**
+     * @brief Queues a message in the bucket of its QoS.
+     */
+    void push(Message&& msg) override;
+
+    /**
+     * @brief Removes the message with the highest (effective) level.
+     *
+     * The arbiter must not be empty.
+     *
+     * @param now Current cycle, used to age the waiting messages.
+     * @return The removed message.
+     */
+    Message pop(uint64_t now) override;
+
+    size_t size() const override { return count; }
+    uint64_t getAgedPicks() const { return aged_picks; }
+};
+
+#endif // QOS_ARBITER_HPP
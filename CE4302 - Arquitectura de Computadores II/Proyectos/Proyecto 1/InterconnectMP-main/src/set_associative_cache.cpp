@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <bit>
+#include "set_associative_cache.hpp"
+
+SetAssociativeCache::SetAssociativeCache(uint32_t sets, uint32_t ways_, uint32_t words, ReplacementPolicy policy_)
+    : num_sets(sets), ways(ways_), line_words(words), policy(policy_),
+      tags(static_cast<size_t>(sets) * ways_, 0), states(static_cast<size_t>(sets) * ways_, LineState::INVALID),
+      lru_stamps(static_cast<size_t>(sets) * ways_, 0), plru_bits(sets, 0),
+      data(static_cast<uint32_t*>(::operator new[](std::max<size_t>(static_cast<size_t>(sets) * ways_ * words, 1) * sizeof(uint32_t),
+                                                   std::align_val_t(CACHE_LINE_SIZE)))) {
+    std::fill_n(data.get(), static_cast<size_t>(sets) * ways_ * words, 0u);
+}
+
+int SetAssociativeCache::findWay(uint32_t line) const {
+    uint32_t set = setOf(line);
+    for (uint32_t way = 0; way < ways; way++) {
+        size_t i = slot(set, way);
+        if (states[i] != LineState::INVALID && tags[i] == line) {
+            return static_cast<int>(way);
+        }
+    }
+    return -1;
+}
+
+void SetAssociativeCache::touch(uint32_t set, uint32_t way) {
+    if (policy == ReplacementPolicy::LRU) {
+        lru_stamps[slot(set, way)] = ++use_counter;
+        return;
+    }
+
+    // Walk the tree from the root and point every node away from this way
+    uint32_t depth = std::countr_zero(ways);
+    uint64_t& bits = plru_bits[set];
+    uint32_t node = 1;
+    for (uint32_t level = 0; level < depth; level++) {
+        uint32_t right = (way >> (depth - 1 - level)) & 1;
+        if (right) {
+            bits &= ~(uint64_t{1} << node);
+        } else {
+            bits |= uint64_t{1} << node;
+        }
+        node = node * 2 + right;
+    }
+}
+
+uint32_t SetAssociativeCache::chooseVictim(uint32_t set) const {
+    for (uint32_t way = 0; way < ways; way++) {
+        if (states[slot(set, way)] == LineState::INVALID) {
+            return way;
+        }
+    }
+
+    if (policy == ReplacementPolicy::LRU) {
+        uint32_t victim = 0;
+        for (uint32_t way = 1; way < ways; way++) {
+            if (lru_stamps[slot(set, way)] < lru_stamps[slot(set, victim)]) {
+                victim = way;
+            }
+        }
+        return victim;
+    }
+
+    // Follow the tree bits down to the pseudo least-recently-used way
+    uint32_t depth = std::countr_zero(ways);
+    uint64_t bits = plru_bits[set];
+    uint32_t node = 1;
+    uint32_t way = 0;
+    for (uint32_t level = 0; level < depth; level++) {
+        uint32_t right = (bits >> node) & 1;
+        way = (way << 1) | right;
+        node = node * 2 + right;
+    }
+    return way;
+}
+
+void SetAssociativeCache::setState(uint32_t set, uint32_t way, LineState new_state) {
+    LineState& current = states[slot(set, way)];
+    dirty_lines += dirty(new_state);
+    dirty_lines -= dirty(current);
+    current = new_state;
+}
+
+void SetAssociativeCache::install(uint32_t set, uint32_t way, uint32_t line, LineState state) {
+    setState(set, way, state);
+    tags[slot(set, way)] = line;
+    touch(set, way);
+}
+
+std::span<uint32_t> SetAssociativeCache::lineData(uint32_t set, uint32_t way) {
+    return {data.get() + slot(set, way) * line_words, line_words};
+}
+
+bool SetAssociativeCache::findDirty(uint32_t& set, uint32_t& way) const {
+    if (dirty_lines == 0) return false;
+    for (size_t i = 0; i < states.size(); i++) {
+        if (dirty(states[i])) {
+            set = static_cast<uint32_t>(i / ways);
+            way = static_cast<uint32_t>(i % ways);
+            return true;
+        }
+    }
+    return false;
+}
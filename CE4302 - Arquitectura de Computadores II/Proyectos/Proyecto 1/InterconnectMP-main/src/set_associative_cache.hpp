@@ -0,0 +1,143 @@
+#ifndef SET_ASSOCIATIVE_CACHE_HPP
+#define SET_ASSOCIATIVE_CACHE_HPP
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <cstdint>
+#include "cache_memory.hpp"
+#include "system_config.hpp"
+
+/**
+ * @brief Coherence state of a cache line (MESI, plus OWNED for MOESI).
+ */
+enum class LineState : uint8_t {
+    INVALID,
+    SHARED,         // Clean, other caches may hold it
+    EXCLUSIVE,      // Clean, no other cache holds it
+    OWNED,          // Dirty, other caches may hold it; this cache answers for memory (MOESI)
+    MODIFIED        // Dirty, no other cache holds it
+};
+
+constexpr size_t NUM_LINE_STATES = 5;
+
+/**
+ * @brief Gets the one-letter name of a line state (I, S, E, O, M).
+ */
+inline char lineStateName(LineState state) {
+    static constexpr char names[NUM_LINE_STATES] = {'I', 'S', 'E', 'O', 'M'};
+    return names[static_cast<size_t>(state)];
+}
+
+/**
+ * @brief Tagged, write-back set-associative cache of shared memory lines.
+ *
+ * Line addresses are byte addresses divided by the line size; a line maps to
+ * set (line % num_sets). Tags, line states and replacement state live in flat
+ * arrays indexed by (set * ways + way), and the line data in one cache-line
+ * aligned word array, like CacheMemory. The cache only stores state; the PE
+ * decides when to fill, write back or evict lines and which coherence state
+ * each line takes.
+ */
+class SetAssociativeCache {
+private:
+    uint32_t num_sets;                  // Number of sets
+    uint32_t ways;                      // Lines per set
+    uint32_t line_words;                // 32-bit words per line
+    ReplacementPolicy policy;           // Victim selection
+    std::vector<uint32_t> tags;         // Line address held by each line
+    std::vector<LineState> states;      // Coherence state of each line
+    std::vector<uint64_t> lru_stamps;   // Last use of each line (LRU)
+    std::vector<uint64_t> plru_bits;    // Tree bits of each set (PLRU)
+    uint64_t use_counter = 0;           // Source of LRU stamps
+    uint32_t dirty_lines = 0;           // Lines in OWNED or MODIFIED state
+    std::unique_ptr<uint32_t[], AlignedWordsDeleter> data;
+
+    size_t slot(uint32_t set, uint32_t way) const { return static_cast<size_t>(set) * ways + way; }
+
+    static bool dirty(LineState state) { return state == LineState::OWNED || state == LineState::MODIFIED; }
+
+public:
+    /**
+     * @brief Constructor creating an empty (all invalid) cache.
+     *
+     * @param sets Number of sets.
+     * @param ways_ Associativity.
+     * @param words Words per line.
+     * @param policy_ Replacement policy (PLRU needs a power-of-two associativity).
+     */
+    SetAssociativeCache(uint32_t sets, uint32_t ways_, uint32_t words, ReplacementPolicy policy_);
+
+    uint32_t numSets() const { return num_sets; }
+    uint32_t numWays() const { return ways; }
+    uint32_t lineWords() const { return line_words; }
+    uint32_t lineBytes() const { return line_words * 4; }
+
+    /**
+     * @brief Gets the line address that contains a byte address.
+     */
+    uint32_t lineOf(uint32_t addr) const { return addr / lineBytes(); }
+
+    /**
+     * @brief Gets the set a line maps to.
+     */
+    uint32_t setOf(uint32_t line) const { return line % num_sets; }
+
+    /**
+     * @brief Looks up a line without touching the replacement state.
+     *
+     * @param line Line address.
+     * @return Way holding the line, or -1 on a miss.
+     */
+    int findWay(uint32_t line) const;
+
+    /**
+     * @brief Records a use of a line for the replacement policy.
+     */
+    void touch(uint32_t set, uint32_t way);
+
+    /**
+     * @brief Picks the way to replace in a set (an invalid way if there is one).
+     */
+    uint32_t chooseVictim(uint32_t set) const;
+
+    /**
+     * @brief Places a line in a way with the given state, and marks it used.
+     */
+    void install(uint32_t set, uint32_t way, uint32_t line, LineState state);
+
+    LineState state(uint32_t set, uint32_t way) const { return states[slot(set, way)]; }
+    bool isValid(uint32_t set, uint32_t way) const { return state(set, way) != LineState::INVALID; }
+    bool isDirty(uint32_t set, uint32_t way) const { return dirty(state(set, way)); }
+
+    /**
+     * @brief Changes the coherence state of a line, keeping the dirty line count.
+     */
+    void setState(uint32_t set, uint32_t way, LineState new_state);
+
+    /**
+     * @brief Checks whether any line holds data not yet written back.
+     */
+    bool hasDirtyLines() const { return dirty_lines > 0; }
+
+    /**
+     * @brief Gets the line address held by a way.
+     */
+    uint32_t lineAt(uint32_t set, uint32_t way) const { return tags[slot(set, way)]; }
+
+    /**
+     * @brief Gets the words of a line.
+     */
+    std::span<uint32_t> lineData(uint32_t set, uint32_t way);
+
+    /**
+     * @brief Finds any dirty line.
+     *
+     * @param set Set of the dirty line, if found.
+     * @param way Way of the dirty line, if found.
+     * @return True if a dirty line exists.
+     */
+    bool findDirty(uint32_t& set, uint32_t& way) const;
+};
+
+#endif // SET_ASSOCIATIVE_CACHE_HPP
@@ -1,57 +1,158 @@
+#include <algorithm>
 #include <random>
 #include <stdexcept>
 #include "shared_memory.hpp"
 
-void SharedMemory::writeByAddress(uint16_t addr, uint32_t value) {
+std::unique_lock<std::mutex> SharedMemory::lockBank(MemoryBank& bank) const {
+    bank.accesses.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(bank.mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        bank.conflicts.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+    return lock;
+}
+
+std::vector<std::unique_lock<std::mutex>> SharedMemory::lockAllBanks() const {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(num_banks);
+    for (uint32_t i = 0; i < num_banks; i++) {
+        locks.emplace_back(banks[i].mutex);
+    }
+    return locks;
+}
+
+SharedMemory::RangeLock::RangeLock(const SharedMemory& mem_, uint32_t pos, uint32_t count)
+    : mem(mem_), first(pos % mem_.num_banks), end(first + std::min(count, mem_.num_banks)) {
+    forEachBank([this](MemoryBank& bank) {
+        bank.accesses.fetch_add(1, std::memory_order_relaxed);
+        if (!bank.mutex.try_lock()) {
+            bank.conflicts.fetch_add(1, std::memory_order_relaxed);
+            bank.mutex.lock();
+        }
+    });
+}
+
+SharedMemory::RangeLock::~RangeLock() {
+    forEachBank([](MemoryBank& bank) { bank.mutex.unlock(); });
+}
+
+template <typename Func>
+void SharedMemory::RangeLock::forEachBank(Func func) const {
+    uint32_t num_banks = mem.num_banks;
+    if (end - first == 1) {
+        func(mem.banks[first]);
+        return;
+    }
+    if (end - first == num_banks) {
+        for (uint32_t bank = 0; bank < num_banks; bank++) {
+            func(mem.banks[bank]);
+        }
+        return;
+    }
+
+    // The touched banks may wrap around; the wrapped part has the lowest indices
+    for (uint32_t bank = 0; end > num_banks && bank < end - num_banks; bank++) {
+        func(mem.banks[bank]);
+    }
+    for (uint32_t bank = first; bank < std::min(end, num_banks); bank++) {
+        func(mem.banks[bank]);
+    }
+}
+
+void SharedMemory::checkRange(uint32_t pos, size_t count) const {
+    if (pos > size || count > size - pos) {
+        throw std::out_of_range("Position range out of range");
+    }
+}
+
+void SharedMemory::enableDirectory(uint32_t line_words, uint16_t num_pes) {
+    line_bytes = line_words * 4;
+    directory.reset(size / line_words, num_pes, false);
+}
+
+uint64_t SharedMemory::getBankAccesses() const {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < num_banks; i++) {
+        total += banks[i].accesses.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t SharedMemory::getBankConflicts() const {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < num_banks; i++) {
+        total += banks[i].conflicts.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void SharedMemory::writeByAddress(uint32_t addr, uint32_t value) {
     // Check if address is aligned to 4 bytes
     if (addr % 4 != 0) {
         throw std::runtime_error("Address not aligned to 4 bytes");
     }
     
-    uint16_t pos = addr / 4;
-    if (pos >= SHARED_MEMORY_SIZE) {
+    uint32_t pos = addr / 4;
+    if (pos >= size) {
         throw std::out_of_range("Position out of range");
     }
     
-    std::lock_guard<std::mutex> lock(mem_mutex);
+    auto lock = lockBank(bankOf(pos));
     memory[pos] = value;
 }
 
-void SharedMemory::writeByPosition(uint16_t pos, uint32_t value) {
-    if (pos >= SHARED_MEMORY_SIZE) {
+void SharedMemory::writeByPosition(uint32_t pos, uint32_t value) {
+    if (pos >= size) {
         throw std::out_of_range("Position out of range");
     }
     
-    std::lock_guard<std::mutex> lock(mem_mutex);
+    auto lock = lockBank(bankOf(pos));
     memory[pos] = value;
 }
 
-uint32_t SharedMemory::readByAddress(uint16_t addr) {
+uint32_t SharedMemory::readByAddress(uint32_t addr) {
     // Check if address is aligned to 4 bytes
     if (addr % 4 != 0) {
         throw std::runtime_error("Address not aligned to 4 bytes");
     }
     
-    uint16_t pos = addr / 4;
-    if (pos >= SHARED_MEMORY_SIZE) {
+    uint32_t pos = addr / 4;
+    if (pos >= size) {
         throw std::out_of_range("Position out of range");
     }
     
-    std::lock_guard<std::mutex> lock(mem_mutex);
+    auto lock = lockBank(bankOf(pos));
     return memory[pos];
 }
 
-uint32_t SharedMemory::readByPosition(uint16_t pos) {
-    if (pos >= SHARED_MEMORY_SIZE) {
+uint32_t SharedMemory::readByPosition(uint32_t pos) {
+    if (pos >= size) {
         throw std::out_of_range("Position out of range");
     }
     
-    std::lock_guard<std::mutex> lock(mem_mutex);
+    auto lock = lockBank(bankOf(pos));
     return memory[pos];
 }
 
+void SharedMemory::readRange(uint32_t pos, std::span<uint32_t> out) {
+    checkRange(pos, out.size());
+    if (out.empty()) return;
+
+    RangeLock lock(*this, pos, static_cast<uint32_t>(out.size()));
+    std::copy_n(memory.begin() + pos, out.size(), out.begin());
+}
+
+void SharedMemory::writeRange(uint32_t pos, std::span<const uint32_t> values) {
+    checkRange(pos, values.size());
+    if (values.empty()) return;
+
+    RangeLock lock(*this, pos, static_cast<uint32_t>(values.size()));
+    std::copy(values.begin(), values.end(), memory.begin() + pos);
+}
+
 void SharedMemory::fillRandom(uint32_t seed) {
-    std::lock_guard<std::mutex> lock(mem_mutex);
+    auto locks = lockAllBanks();
     
     std::mt19937 gen(seed);
     std::uniform_int_distribution<uint32_t> dist;
@@ -68,7 +169,7 @@ bool SharedMemory::loadFromFile(const std::string& filename) {
             return false;
         }
 
-        std::lock_guard<std::mutex> lock(mem_mutex);
+        auto locks = lockAllBanks();
         
         std::string line;
         size_t pos = 0;
@@ -84,7 +185,7 @@ bool SharedMemory::loadFromFile(const std::string& filename) {
             }
             
             // Check if memory size was exceeded
-            if (pos >= SHARED_MEMORY_SIZE) {
+            if (pos >= size) {
                 return false; // Too much data in the file
             }
             
@@ -125,7 +226,7 @@ bool SharedMemory::saveToFile(const std::string& filename) {
             return false;
         }
         
-        std::lock_guard<std::mutex> lock(mem_mutex);
+        auto locks = lockAllBanks();
         
         file << std::hex << std::uppercase << std::setfill('0');
         for (const auto& word : memory) {
@@ -144,8 +245,9 @@ bool SharedMemory::saveToFile(const std::string& filename) {
 
 void SharedMemory::showInfo() const {
     std::cout << "Shared Memory:\n";
-    std::cout << " - Total positions: " << SHARED_MEMORY_SIZE << "\n";
+    std::cout << " - Total positions: " << size << "\n";
     std::cout << " - Size per position: 32 bits (4 bytes)\n";
-    std::cout << " - Total size: " << (SHARED_MEMORY_SIZE * 4) << " bytes\n";
+    std::cout << " - Total size: " << (static_cast<uint64_t>(size) * 4) << " bytes\n";
+    std::cout << " - Banks: " << num_banks << " (interleaved by position)\n";
     std::cout << " - Alignment: 4 bytes\n";
 }
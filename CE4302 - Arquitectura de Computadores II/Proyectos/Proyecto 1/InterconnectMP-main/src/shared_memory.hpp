@@ -3,31 +3,147 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <span>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <random>
 #include <stdexcept>
 #include "constants.hpp"
+#include "directory.hpp"
 
 /**
- * @brief Class representing a shared memory with thread-safe operations.
+ * @brief Lock and counters of one shared memory bank.
+ *
+ * Padded to a cache line so that banks locked by different threads do not
+ * share a line.
+ */
+struct alignas(CACHE_LINE_SIZE) MemoryBank {
+    std::mutex mutex;                       // Guards every position mapped to this bank
+    std::atomic<uint64_t> accesses{0};      // Lock acquisitions
+    std::atomic<uint64_t> conflicts{0};     // Acquisitions that found the bank busy
+};
+
+/**
+ * @brief Class representing a banked shared memory with thread-safe operations.
  * 
+ * Positions are interleaved across banks (position % num_banks) and every
+ * bank has its own lock, so accesses to different banks proceed in parallel.
  * Provides methods for reading and writing 32-bit words to shared memory,
  * as well as loading and saving its contents from/to files.
  */
 class SharedMemory {
 private:
-    std::vector<uint32_t> memory;   // Stores 32-bit words (4 bytes)
-    std::mutex mem_mutex;           // Mutex to ensure thread-safe access
+    uint32_t size;                          // Number of 32-bit positions
+    uint32_t num_banks;                     // Number of interleaved banks
+    std::vector<uint32_t> memory;           // Stores 32-bit words (4 bytes)
+    std::unique_ptr<MemoryBank[]> banks;    // Per-bank locks and counters
+    Directory directory;                    // PEs caching each line (coherent caches only)
+    uint32_t line_bytes = 0;                // Line size tracked by the directory
+
+    /**
+     * @brief Gets the bank that holds a position.
+     */
+    MemoryBank& bankOf(uint32_t pos) const { return banks[pos % num_banks]; }
+
+    /**
+     * @brief Locks a bank, counting a conflict if another thread holds it.
+     *
+     * @param bank The bank to lock.
+     * @return Lock owning the bank mutex.
+     */
+    std::unique_lock<std::mutex> lockBank(MemoryBank& bank) const;
+
+    /**
+     * @brief Locks every bank in index order (for whole-memory operations).
+     *
+     * @return Locks owning all bank mutexes.
+     */
+    std::vector<std::unique_lock<std::mutex>> lockAllBanks() const;
+
+    /**
+     * @brief Scoped lock over every bank touched by a range of positions.
+     *
+     * Banks are acquired in index order, like lockAllBanks, so range and
+     * whole-memory operations cannot deadlock. Holds no heap state, which
+     * keeps short transfers as cheap as a single-word access.
+     */
+    class RangeLock {
+    private:
+        const SharedMemory& mem;
+        uint32_t first;     // Bank of the first position
+        uint32_t end;       // first + number of touched banks (may pass num_banks)
+
+        template <typename Func>
+        void forEachBank(Func func) const;
+
+    public:
+        RangeLock(const SharedMemory& mem_, uint32_t pos, uint32_t count);
+        ~RangeLock();
+
+        RangeLock(const RangeLock&) = delete;
+        RangeLock& operator=(const RangeLock&) = delete;
+    };
+
+    /**
+     * @brief Checks that a range of positions lies inside the memory.
+     *
+     * @throws std::out_of_range if the range exceeds the memory size
+     */
+    void checkRange(uint32_t pos, size_t count) const;
     
 public:
     /**
      * @brief Constructor initializing shared memory with zeros.
      * 
-     * Allocates memory of size SHARED_MEMORY_SIZE and initializes all words to zero.
+     * Allocates the given number of positions and initializes all words to zero.
+     *
+     * @param positions Number of 32-bit positions (default: SHARED_MEMORY_SIZE)
+     * @param bank_count Number of interleaved banks (default: DEFAULT_MEMORY_BANKS)
+     */
+    explicit SharedMemory(uint32_t positions = SHARED_MEMORY_SIZE, uint32_t bank_count = DEFAULT_MEMORY_BANKS)
+        : size(positions), num_banks(bank_count == 0 ? 1 : bank_count), memory(positions, 0),
+          banks(new MemoryBank[num_banks]) {}
+
+    /**
+     * @brief Gets the number of 32-bit positions of the shared memory.
+     */
+    uint32_t getSize() const { return size; }
+
+    /**
+     * @brief Gets the number of banks of the shared memory.
+     */
+    uint32_t getNumBanks() const { return num_banks; }
+
+    /**
+     * @brief Starts tracking which PEs cache each line of the memory.
+     *
+     * @param line_words Words per cache line.
+     * @param num_pes Number of PEs.
+     */
+    void enableDirectory(uint32_t line_words, uint16_t num_pes);
+
+    /**
+     * @brief Gets the sharer directory (empty unless enableDirectory was called).
      */
-    SharedMemory() : memory(SHARED_MEMORY_SIZE, 0) {}
+    Directory& getDirectory() { return directory; }
+
+    /**
+     * @brief Gets the directory entry of the line that contains a byte address.
+     */
+    uint32_t directoryLine(uint32_t addr) const { return addr / line_bytes; }
+
+    /**
+     * @brief Gets the total number of bank lock acquisitions.
+     */
+    uint64_t getBankAccesses() const;
+
+    /**
+     * @brief Gets the number of accesses that found their bank locked by another thread.
+     */
+    uint64_t getBankConflicts() const;
 
     /**
      * @brief Writes a 32-bit value to a memory address aligned to 4 bytes.
@@ -38,7 +154,7 @@ public:
      * @throws std::runtime_error if address is not aligned to 4 bytes
      * @throws std::out_of_range if position is out of bounds
      */
-    void writeByAddress(uint16_t addr, uint32_t value);
+    void writeByAddress(uint32_t addr, uint32_t value);
 
     /**
      * @brief Writes a 32-bit value to a specified memory position.
@@ -48,7 +164,7 @@ public:
      * 
      * @throws std::out_of_range if position is out of bounds
      */
-    void writeByPosition(uint16_t pos, uint32_t value);
+    void writeByPosition(uint32_t pos, uint32_t value);
 
     /**
      * @brief Reads a 32-bit value from a memory address aligned to 4 bytes.
@@ -59,7 +175,7 @@ public:
      * @throws std::runtime_error if address is not aligned to 4 bytes
      * @throws std::out_of_range if position is out of bounds
      */
-    uint32_t readByAddress(uint16_t addr);
+    uint32_t readByAddress(uint32_t addr);
 
     /**
      * @brief Reads a 32-bit value from a specified memory position.
@@ -69,7 +185,30 @@ public:
      * 
      * @throws std::out_of_range if position is out of bounds
      */
-    uint32_t readByPosition(uint16_t pos);
+    uint32_t readByPosition(uint32_t pos);
+
+    /**
+     * @brief Reads consecutive 32-bit words starting at a memory position.
+     * 
+     * The range is validated once and its banks are locked once, so the
+     * whole transfer is atomic with respect to other range operations.
+     * 
+     * @param pos First memory position
+     * @param out Destination words (its size is the number of words to read)
+     * 
+     * @throws std::out_of_range if the range exceeds the memory size
+     */
+    void readRange(uint32_t pos, std::span<uint32_t> out);
+
+    /**
+     * @brief Writes consecutive 32-bit words starting at a memory position.
+     * 
+     * @param pos First memory position
+     * @param values Words to write
+     * 
+     * @throws std::out_of_range if the range exceeds the memory size
+     */
+    void writeRange(uint32_t pos, std::span<const uint32_t> values);
 
     /**
      * @brief Fills shared memory with random 32-bit values.
@@ -0,0 +1,73 @@
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "sim_clock.hpp"
+
+uint64_t CycleCosts::serviceCycles(const Message& msg, size_t invalidated_pes) const {
+    switch (msg.type) {
+        case MessageType::READ_MEM:
+            return read_mem + read_mem_per_word * msg.size;
+        case MessageType::WRITE_MEM:
+            return write_mem + write_mem_per_word * msg.data.size();
+        case MessageType::BROADCAST_INVALIDATE:
+            return broadcast_invalidate + invalidate_per_pe * invalidated_pes;
+        case MessageType::READ_SHARED:
+        case MessageType::READ_EXCLUSIVE:
+            return read_mem + read_mem_per_word * msg.size + invalidate_per_pe * invalidated_pes;
+        case MessageType::UPGRADE:
+            return broadcast_invalidate + invalidate_per_pe * invalidated_pes;
+        case MessageType::WRITEBACK:
+            return write_mem + write_mem_per_word * msg.data.size();
+        default:
+            return 0;
+    }
+}
+
+CycleCosts loadCycleCosts(const std::string& filename) {
+    CycleCosts costs;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Ignore blank lines (spaces, CRLF endings) or lines starting with "#"
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        std::istringstream iss(line);
+        std::string key, value_str;
+        iss >> key >> value_str; // Read "KEY:" and the value
+
+        if (!key.empty() && key.back() == ':') {
+            key.pop_back();
+        }
+
+        uint64_t value;
+        try {
+            value = std::stoull(value_str, nullptr, 0);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Invalid value: " + value_str);
+        }
+
+        if (key == "ARBITRATION") costs.arbitration = value;
+        else if (key == "READ_MEM") costs.read_mem = value;
+        else if (key == "READ_MEM_PER_WORD") costs.read_mem_per_word = value;
+        else if (key == "WRITE_MEM") costs.write_mem = value;
+        else if (key == "WRITE_MEM_PER_WORD") costs.write_mem_per_word = value;
+        else if (key == "BROADCAST_INVALIDATE") costs.broadcast_invalidate = value;
+        else if (key == "INVALIDATE_PER_PE") costs.invalidate_per_pe = value;
+        else if (key == "RESPONSE") costs.response = value;
+        else if (key == "PE_ISSUE") costs.pe_issue = value;
+        else if (key == "CACHE_HIT") costs.cache_hit = value;
+        else if (key == "HOP") costs.hop = value;
+        else if (key == "FLIT") costs.flit = value;
+        else throw std::invalid_argument("Unknown timing key: " + key);
+    }
+
+    return costs;
+}
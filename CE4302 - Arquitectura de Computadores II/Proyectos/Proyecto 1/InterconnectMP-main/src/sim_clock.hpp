@@ -0,0 +1,81 @@
+#ifndef SIM_CLOCK_HPP
+#define SIM_CLOCK_HPP
+
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include "message.hpp"
+
+/**
+ * @brief Cycle costs charged by the virtual clock for each simulated action.
+ *
+ * Default values are used for any key missing from the timing config file.
+ */
+struct CycleCosts {
+    uint64_t arbitration = 2;               // Picking the next message from the queue
+    uint64_t read_mem = 20;                 // Fixed cost of a READ_MEM
+    uint64_t read_mem_per_word = 1;         // Additional cost per word read
+    uint64_t write_mem = 20;                // Fixed cost of a WRITE_MEM
+    uint64_t write_mem_per_word = 1;        // Additional cost per word written
+    uint64_t broadcast_invalidate = 10;     // Fixed cost of a BROADCAST_INVALIDATE
+    uint64_t invalidate_per_pe = 2;         // Cost of invalidating the line in one PE
+    uint64_t response = 4;                  // Delivering a response back to the PE
+    uint64_t pe_issue = 1;                  // PE cycles to issue an instruction
+    uint64_t cache_hit = 1;                 // PE cycles to serve one line from the set-associative cache
+    uint64_t hop = 1;                       // Crossing one router and link of the network
+    uint64_t flit = 1;                      // Cycles a flit occupies a network link
+
+    /**
+     * @brief Computes the cycles the interconnect spends servicing a message.
+     *
+     * @param msg The message being serviced.
+     * @param invalidated_pes Number of PEs reached by an invalidation or a coherence snoop.
+     * @return Service cycles, excluding arbitration and response delivery.
+     */
+    uint64_t serviceCycles(const Message& msg, size_t invalidated_pes) const;
+};
+
+/**
+ * @brief Loads cycle costs from a file of "KEY: value" lines.
+ *
+ * @param filename Path to file containing the timing configuration.
+ * @return The loaded costs.
+ * @throws std::runtime_error if the file cannot be opened.
+ * @throws std::invalid_argument if a value is not a number or out of range, or a key is unknown.
+ */
+CycleCosts loadCycleCosts(const std::string& filename);
+
+/**
+ * @brief Virtual clock measured in simulated cycles.
+ *
+ * Time only moves when the model charges a cost, so results do not depend
+ * on how fast the host runs the simulation.
+ */
+class SimClock {
+private:
+    uint64_t cycle = 0;     // Current simulated cycle
+
+public:
+    /**
+     * @brief Gets the current simulated cycle.
+     */
+    uint64_t now() const { return cycle; }
+
+    /**
+     * @brief Moves the clock forward by a number of cycles.
+     *
+     * @param cycles Cycles to advance.
+     * @return The new current cycle.
+     */
+    uint64_t advance(uint64_t cycles) { return cycle += cycles; }
+
+    /**
+     * @brief Moves the clock to a later cycle (never backwards).
+     *
+     * @param target Cycle to reach.
+     * @return The new current cycle.
+     */
+    uint64_t advanceTo(uint64_t target) { return cycle = std::max(cycle, target); }
+};
+
+#endif // SIM_CLOCK_HPP
@@ -0,0 +1,207 @@
+#ifndef SYSTEM_CONFIG_HPP
+#define SYSTEM_CONFIG_HPP
+
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include "constants.hpp"
+
+/**
+ * @brief Model used for the PE cache.
+ */
+enum class CacheMode {
+    SCRATCHPAD,         // Directly indexed blocks; every READ_MEM/WRITE_MEM goes to the interconnect
+    SET_ASSOCIATIVE     // Tagged write-back cache; only misses and evictions reach the interconnect
+};
+
+/**
+ * @brief Replacement policy of the set-associative cache.
+ */
+enum class ReplacementPolicy {
+    LRU,                // True least-recently-used
+    PLRU                // Tree pseudo-LRU (power-of-two associativity)
+};
+
+/**
+ * @brief Gets the command-line name of a replacement policy.
+ */
+inline const char* replacementPolicyName(ReplacementPolicy policy) {
+    return policy == ReplacementPolicy::PLRU ? "plru" : "lru";
+}
+
+/**
+ * @brief Coherence protocol kept by the set-associative caches.
+ */
+enum class CoherenceProtocol {
+    MESI,               // Dirty lines are written to memory when another cache reads them
+    MOESI               // A dirty line read by another cache stays OWNED instead
+};
+
+/**
+ * @brief Gets the display name of a coherence protocol.
+ */
+inline const char* coherenceProtocolName(CoherenceProtocol protocol) {
+    return protocol == CoherenceProtocol::MOESI ? "MOESI" : "MESI";
+}
+
+/**
+ * @brief On-chip network between the PEs and the shared memory banks.
+ */
+enum class NetworkTopology {
+    IDEAL,              // No distance or links: only the interconnect queue is modeled
+    BUS,                // One shared link
+    RING,               // Bidirectional ring
+    MESH,               // 2D mesh, XY routing
+    TORUS,              // 2D mesh with wraparound links
+    CROSSBAR            // One hop to every router, contention at the output port
+};
+
+/**
+ * @brief Gets the command-line name of a network topology.
+ */
+inline const char* networkTopologyName(NetworkTopology topology) {
+    switch (topology) {
+        case NetworkTopology::BUS: return "bus";
+        case NetworkTopology::RING: return "ring";
+        case NetworkTopology::MESH: return "mesh";
+        case NetworkTopology::TORUS: return "torus";
+        case NetworkTopology::CROSSBAR: return "crossbar";
+        case NetworkTopology::IDEAL: break;
+    }
+    return "ideal";
+}
+
+/**
+ * @brief Order in which the interconnect services queued messages.
+ */
+enum class ArbitrationScheme {
+    FIFO,               // Arrival order (lock-free ring)
+    QOS,                // Highest PE QoS first
+    ROUND_ROBIN,        // One message per PE in turn
+    WFQ,                // Weighted fair queuing, weight = QoS + 1
+    DRR                 // Deficit round-robin by message bytes
+};
+
+/**
+ * @brief Gets the command-line name of an arbitration scheme.
+ */
+inline const char* arbitrationSchemeName(ArbitrationScheme scheme) {
+    switch (scheme) {
+        case ArbitrationScheme::QOS: return "qos";
+        case ArbitrationScheme::ROUND_ROBIN: return "rr";
+        case ArbitrationScheme::WFQ: return "wfq";
+        case ArbitrationScheme::DRR: return "drr";
+        case ArbitrationScheme::FIFO: break;
+    }
+    return "fifo";
+}
+
+/**
+ * @brief Gets the name of an arbitration scheme shown in the stats.
+ */
+inline const char* arbitrationSchemeLabel(ArbitrationScheme scheme) {
+    switch (scheme) {
+        case ArbitrationScheme::QOS: return "QoS";
+        case ArbitrationScheme::ROUND_ROBIN: return "RR";
+        case ArbitrationScheme::WFQ: return "WFQ";
+        case ArbitrationScheme::DRR: return "DRR";
+        case ArbitrationScheme::FIFO: break;
+    }
+    return "FIFO";
+}
+
+/**
+ * @brief Runtime sizes of the simulated system.
+ *
+ * Defaults match the original fixed configuration (constants.hpp); every
+ * value can be changed from the command line.
+ */
+struct SystemConfig {
+    uint16_t num_pes = DEFAULT_NUM_PES;                 // Number of processing elements
+    uint32_t shared_memory_size = SHARED_MEMORY_SIZE;   // Shared memory size in 32-bit positions
+    uint32_t cache_blocks = NUMBER_OF_CACHE_BLOCKS;     // Cache blocks per PE
+    uint32_t words_per_block = WORDS_PER_BLOCK;         // 32-bit words per cache block
+    uint32_t memory_banks = DEFAULT_MEMORY_BANKS;       // Interleaved shared memory banks
+
+    // Set-associative cache mode
+    CacheMode cache_mode = CacheMode::SCRATCHPAD;
+    uint32_t cache_sets = DEFAULT_CACHE_SETS;           // Number of sets
+    uint32_t cache_ways = DEFAULT_CACHE_WAYS;           // Lines per set
+    uint32_t line_words = DEFAULT_LINE_WORDS;           // 32-bit words per line
+    ReplacementPolicy replacement = ReplacementPolicy::LRU;
+    CoherenceProtocol coherence = CoherenceProtocol::MESI;
+    bool use_directory = true;                          // Send invalidations/snoops to tracked sharers only
+    uint32_t mshrs = DEFAULT_MSHRS;                     // Requests each PE may have in flight
+    uint32_t interconnect_workers = DEFAULT_INTERCONNECT_WORKERS; // Interconnect threads, each owning a block-interleaved address shard
+    NetworkTopology topology = NetworkTopology::IDEAL;  // Network crossed by requests and responses
+
+    /**
+     * @brief Gets the shared memory size in bytes.
+     */
+    uint64_t memoryBytes() const { return static_cast<uint64_t>(shared_memory_size) * 4; }
+
+    /**
+     * @brief Gets the number of 32-bit words held by one PE cache.
+     */
+    uint64_t cacheWords() const { return static_cast<uint64_t>(cache_blocks) * words_per_block; }
+
+    /**
+     * @brief Gets the number of 32-bit words held by one set-associative cache.
+     */
+    uint64_t taggedCacheWords() const { return static_cast<uint64_t>(cache_sets) * cache_ways * line_words; }
+
+    /**
+     * @brief Checks that every value is within the supported limits.
+     *
+     * @throws std::out_of_range if a value is out of range.
+     */
+    void validate() const {
+        if (num_pes < MIN_NUM_PES || num_pes > MAX_NUM_PES) {
+            throw std::out_of_range("Number of PEs must be between " + 
+                std::to_string(MIN_NUM_PES) + " and " + std::to_string(MAX_NUM_PES));
+        }
+        if (shared_memory_size == 0 || shared_memory_size > MAX_SHARED_MEMORY_SIZE) {
+            throw std::out_of_range("Shared memory size must be between 1 and " + 
+                std::to_string(MAX_SHARED_MEMORY_SIZE) + " positions");
+        }
+        if (cache_blocks == 0 || words_per_block == 0 || cacheWords() > MAX_CACHE_WORDS) {
+            throw std::out_of_range("Cache size must be between 1 and " + 
+                std::to_string(MAX_CACHE_WORDS) + " words");
+        }
+        if (memory_banks == 0 || memory_banks > MAX_MEMORY_BANKS) {
+            throw std::out_of_range("Number of memory banks must be between 1 and " + 
+                std::to_string(MAX_MEMORY_BANKS));
+        }
+        if (mshrs == 0 || mshrs > MAX_MSHRS) {
+            throw std::out_of_range("Number of MSHRs must be between 1 and " + std::to_string(MAX_MSHRS));
+        }
+        if (cache_mode == CacheMode::SET_ASSOCIATIVE && mshrs > 1) {
+            throw std::out_of_range("Multiple MSHRs are only supported with the scratchpad cache");
+        }
+        if (interconnect_workers == 0 || interconnect_workers > MAX_INTERCONNECT_WORKERS) {
+            throw std::out_of_range("Number of interconnect workers must be between 1 and " +
+                std::to_string(MAX_INTERCONNECT_WORKERS));
+        }
+        if (cache_mode == CacheMode::SET_ASSOCIATIVE && interconnect_workers > 1) {
+            throw std::out_of_range("Multiple interconnect workers are only supported with the scratchpad cache");
+        }
+        if (cache_mode == CacheMode::SET_ASSOCIATIVE) {
+            if (cache_sets == 0 || line_words == 0 || taggedCacheWords() > MAX_CACHE_WORDS) {
+                throw std::out_of_range("Set-associative cache size must be between 1 and " + 
+                    std::to_string(MAX_CACHE_WORDS) + " words");
+            }
+            if (cache_ways == 0 || cache_ways > MAX_CACHE_WAYS) {
+                throw std::out_of_range("Associativity must be between 1 and " + std::to_string(MAX_CACHE_WAYS));
+            }
+            if (replacement == ReplacementPolicy::PLRU && (cache_ways & (cache_ways - 1)) != 0) {
+                throw std::out_of_range("PLRU replacement requires a power-of-two associativity");
+            }
+            if (shared_memory_size % line_words != 0) {
+                throw std::out_of_range("Shared memory size must be a multiple of the line size");
+            }
+        }
+    }
+};
+
+#endif // SYSTEM_CONFIG_HPP
@@ -0,0 +1,29 @@
+#include <iostream>
+#include "../instruction_memory.hpp"
+
+/**
+ * Compiles a text workload (inst_pe_N.txt format) into a binary trace of
+ * packed InstructionRecords, which the simulator maps instead of parsing.
+ *
+ * Usage: ./tools/compile_workload INPUT.txt OUTPUT.bin
+ */
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " INPUT.txt OUTPUT.bin\n";
+        return 1;
+    }
+
+    InstructionMemory memory;
+    if (!memory.loadFromFile(argv[1])) {
+        std::cerr << "Error: Failed to load " << argv[1] << "\n";
+        return 1;
+    }
+    if (!memory.saveBinary(argv[2])) {
+        std::cerr << "Error: Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::cout << argv[2] << ": " << memory.remaining() << " instructions\n";
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "../event_log.hpp"
+
+/**
+ * Renders a binary message log (written with --log-format binary) in the
+ * layout of interconnect_log.txt / pes_log.txt.
+ *
+ * Usage: ./tools/decode_log LOG.bin [OUTPUT.txt]
+ *   e.g. ./tools/decode_log ../resources/logs/interconnect_log.bin ../resources/logs/interconnect_log.txt
+ */
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " LOG.bin [OUTPUT.txt]\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    try {
+        if (argc == 3) {
+            std::ofstream out(argv[2], std::ios::out | std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "Error: Failed to open " << argv[2] << "\n";
+                return 1;
+            }
+            size_t records = EventLog::decode(in, out);
+            std::cerr << records << " records decoded to " << argv[2] << "\n";
+        } else {
+            EventLog::decode(in, std::cout);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include <cmath>
+#include <algorithm>
+#include "topology.hpp"
+
+BusTopology::BusTopology(uint32_t routers) {
+    num_routers = routers;
+    link_names.push_back("bus");
+}
+
+void BusTopology::route(uint32_t, uint32_t, std::vector<uint32_t>& path) const {
+    path.push_back(0);
+}
+
+CrossbarTopology::CrossbarTopology(uint32_t routers) {
+    num_routers = routers;
+    for (uint32_t r = 0; r < routers; r++) {
+        link_names.push_back("port " + std::to_string(r));
+    }
+}
+
+void CrossbarTopology::route(uint32_t, uint32_t to, std::vector<uint32_t>& path) const {
+    path.push_back(to);
+}
+
+RingTopology::RingTopology(uint32_t routers) {
+    num_routers = routers;
+    for (uint32_t r = 0; r < routers; r++) {
+        link_names.push_back(std::to_string(r) + "->" + std::to_string((r + 1) % routers));
+    }
+    for (uint32_t r = 0; r < routers; r++) {
+        link_names.push_back(std::to_string(r) + "->" + std::to_string((r + routers - 1) % routers));
+    }
+}
+
+void RingTopology::route(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const {
+    uint32_t clockwise = (to + num_routers - from) % num_routers;
+    if (clockwise <= num_routers - clockwise) {
+        for (uint32_t r = from; r != to; r = (r + 1) % num_routers) {
+            path.push_back(r);
+        }
+    } else {
+        for (uint32_t r = from; r != to; r = (r + num_routers - 1) % num_routers) {
+            path.push_back(num_routers + r);
+        }
+    }
+}
+
+MeshTopology::MeshTopology(uint32_t nodes, bool torus) : wrap(torus) {
+    width = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+    height = (nodes + width - 1) / width;
+    num_routers = width * height;
+
+    static const char* port_names[NUM_PORTS] = {"E", "W", "N", "S"};
+    port_links.assign(static_cast<size_t>(num_routers) * NUM_PORTS, -1);
+    for (uint32_t r = 0; r < num_routers; r++) {
+        for (int p = 0; p < NUM_PORTS; p++) {
+            int64_t next = neighbor(r, static_cast<Port>(p));
+            if (next < 0 || next == r) continue;    // Mesh edge, or a 1-wide torus dimension
+
+            port_links[static_cast<size_t>(r) * NUM_PORTS + p] = static_cast<int32_t>(link_names.size());
+            link_names.push_back("(" + std::to_string(r % width) + "," + std::to_string(r / width) + ")" +
+                                 port_names[p]);
+        }
+    }
+}
+
+int64_t MeshTopology::neighbor(uint32_t router, Port port) const {
+    uint32_t x = router % width;
+    uint32_t y = router / width;
+    switch (port) {
+        case EAST:
+            if (x + 1 < width) return router + 1;
+            return wrap ? router + 1 - width : -1;
+        case WEST:
+            if (x > 0) return router - 1;
+            return wrap ? router + width - 1 : -1;
+        case NORTH:
+            if (y > 0) return router - width;
+            return wrap ? router + (height - 1) * width : -1;
+        case SOUTH:
+            if (y + 1 < height) return router + width;
+            return wrap ? x : -1;
+        default:
+            return -1;
+    }
+}
+
+void MeshTopology::walk(uint32_t& router, uint32_t target, bool horizontal, std::vector<uint32_t>& path) const {
+    uint32_t size = horizontal ? width : height;
+    uint32_t current = horizontal ? router % width : router / width;
+    if (current == target) return;
+
+    uint32_t forward = (target + size - current) % size;   // Steps east/south with wraparound
+    bool positive;
+    uint32_t steps;
+    if (wrap) {
+        positive = forward <= size - forward;
+        steps = positive ? forward : size - forward;
+    } else {
+        positive = target > current;
+        steps = positive ? target - current : current - target;
+    }
+
+    Port port = horizontal ? (positive ? EAST : WEST) : (positive ? SOUTH : NORTH);
+    for (uint32_t i = 0; i < steps; i++) {
+        path.push_back(static_cast<uint32_t>(port_links[static_cast<size_t>(router) * NUM_PORTS + port]));
+        router = static_cast<uint32_t>(neighbor(router, port));
+    }
+}
+
+void MeshTopology::route(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const {
+    uint32_t router = from;
+    walk(router, to % width, true, path);
+    walk(router, to / width, false, path);
+}
+
+std::unique_ptr<Topology> makeTopology(NetworkTopology topology, uint32_t nodes) {
+    switch (topology) {
+        case NetworkTopology::BUS: return std::make_unique<BusTopology>(nodes);
+        case NetworkTopology::RING: return std::make_unique<RingTopology>(nodes);
+        case NetworkTopology::MESH: return std::make_unique<MeshTopology>(nodes, false);
+        case NetworkTopology::TORUS: return std::make_unique<MeshTopology>(nodes, true);
+        case NetworkTopology::CROSSBAR: return std::make_unique<CrossbarTopology>(nodes);
+        case NetworkTopology::IDEAL: break;
+    }
+    return nullptr;
+}
+
+uint64_t Network::Link::reserve(uint64_t cycle, uint64_t length) {
+    busy += length;
+    if (length == 0) return cycle;
+
+    // Skip every interval that overlaps [cycle, cycle + length)
+    auto next = reserved.upper_bound(cycle);
+    if (next != reserved.begin()) {
+        cycle = std::max(cycle, std::prev(next)->second);
+    }
+    while (next != reserved.end() && next->first < cycle + length) {
+        cycle = std::max(cycle, next->second);
+        ++next;
+    }
+    reserved.emplace_hint(next, cycle, cycle + length);
+
+    // Forget the oldest intervals; transfers that far back no longer arrive
+    while (reserved.size() > MAX_LINK_RESERVATIONS) {
+        reserved.erase(reserved.begin());
+    }
+    return cycle;
+}
+
+void Network::configure(NetworkTopology kind, uint32_t pes, uint32_t banks) {
+    std::lock_guard<std::mutex> lock(mutex);
+    num_pes = pes;
+    num_banks = std::max<uint32_t>(banks, 1);
+    topology = makeTopology(kind, pes);
+
+    links.assign(topology ? topology->numLinks() : 0, Link{});
+    traversals = total_hops = contention_cycles = 0;
+}
+
+std::vector<uint64_t> Network::getLinkBusyCycles() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<uint64_t> busy;
+    for (const auto& link : links) {
+        busy.push_back(link.busy);
+    }
+    return busy;
+}
+
+uint64_t Network::traverse(uint32_t from, uint32_t to, uint64_t start, uint32_t flits,
+                           uint64_t hop_cycles, uint64_t flit_cycles) {
+    std::lock_guard<std::mutex> lock(mutex);
+    path.clear();
+    topology->route(from, to, path);
+
+    uint64_t cycle = start;
+    uint64_t occupancy = flits * flit_cycles;
+    for (uint32_t link : path) {
+        uint64_t ready = links[link].reserve(cycle, occupancy);
+        contention_cycles += ready - cycle;
+        cycle = ready + hop_cycles;
+    }
+
+    traversals++;
+    total_hops += path.size();
+    return path.empty() ? start : cycle + (flits - 1) * flit_cycles;
+}
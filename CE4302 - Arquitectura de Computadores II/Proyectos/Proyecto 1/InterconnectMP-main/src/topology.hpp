@@ -0,0 +1,221 @@
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "constants.hpp"
+#include "system_config.hpp"
+
+/**
+ * @brief Routers and directed links of an on-chip network.
+ *
+ * PE i sits on router i; the routers of a mesh or torus may outnumber the
+ * PEs when the PE count does not fill the grid. A topology only knows its
+ * links and how to route between two routers; link occupancy is kept by
+ * Network.
+ */
+class Topology {
+protected:
+    uint32_t num_routers = 0;               // Routers of the network
+    std::vector<std::string> link_names;    // Name of each directed link
+
+public:
+    virtual ~Topology() = default;
+
+    /**
+     * @brief Gets the command-line name of the topology.
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Appends the links crossed from one router to another, in order.
+     *
+     * @param from Source router.
+     * @param to Destination router.
+     * @param path Destination of the link IDs (not cleared).
+     */
+    virtual void route(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const = 0;
+
+    uint32_t numRouters() const { return num_routers; }
+
+    uint32_t numLinks() const { return static_cast<uint32_t>(link_names.size()); }
+
+    const std::string& linkName(uint32_t link) const { return link_names[link]; }
+};
+
+/**
+ * @brief Single shared bus: every transfer occupies the same link.
+ */
+class BusTopology : public Topology {
+public:
+    explicit BusTopology(uint32_t routers);
+    const char* name() const override { return "bus"; }
+    void route(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const override;
+};
+
+/**
+ * @brief Crossbar: one hop to any router, transfers contend on the output port.
+ */
+class CrossbarTopology : public Topology {
+public:
+    explicit CrossbarTopology(uint32_t routers);
+    const char* name() const override { return "crossbar"; }
+    void route(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const override;
+};
+
+/**
+ * @brief Bidirectional ring routed along the shorter direction.
+ *
+ * Link i goes clockwise from router i to i + 1, link routers + i
+ * counterclockwise from router i to i - 1.
+ */
+class RingTopology : public Topology {
+public:
+    explicit RingTopology(uint32_t routers);
+    const char* name() const override { return "ring"; }
+    void route(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const override;
+};
+
+/**
+ * @brief 2D mesh, or torus with wraparound links, with XY dimension-order routing.
+ *
+ * The grid is ceil(sqrt(n)) routers wide; router r sits at
+ * (r % width, r / width). A torus takes the shorter direction in each dimension.
+ */
+class MeshTopology : public Topology {
+private:
+    enum Port { EAST, WEST, NORTH, SOUTH, NUM_PORTS };
+
+    bool wrap;                              // Torus: links wrap around at the edges
+    uint32_t width;                         // Routers per row
+    uint32_t height;                        // Rows
+    std::vector<int32_t> port_links;        // Link leaving each (router, port), -1 at mesh edges
+
+    /**
+     * @brief Gets the router reached through a port, or -1 past a mesh edge.
+     */
+    int64_t neighbor(uint32_t router, Port port) const;
+
+    /**
+     * @brief Appends the links that move along one dimension.
+     *
+     * @param router Current router, updated to the last router reached.
+     * @param target Coordinate to reach.
+     * @param horizontal True to move along x, false along y.
+     */
+    void walk(uint32_t& router, uint32_t target, bool horizontal, std::vector<uint32_t>& path) const;
+
+public:
+    MeshTopology(uint32_t nodes, bool torus);
+    const char* name() const override { return wrap ? "torus" : "mesh"; }
+    void route(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const override;
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+};
+
+/**
+ * @brief Creates the topology of a network.
+ *
+ * @param topology Kind of network (must not be IDEAL).
+ * @param nodes Number of PEs attached to the network.
+ * @return The topology, or nullptr for IDEAL.
+ */
+std::unique_ptr<Topology> makeTopology(NetworkTopology topology, uint32_t nodes);
+
+/**
+ * @brief Link occupancy of the on-chip network between the PEs and the memory banks.
+ *
+ * Memory bank b is attached to router (b * PEs / banks). A transfer of F
+ * flits takes the first free slot of F flit times at each link of its
+ * route and moves on after one hop latency; the tail arrives F - 1 flit
+ * times after the head. Transfers are routed in service order, not in
+ * cycle order, so each link keeps its reserved intervals and an earlier
+ * transfer can still use a gap before a later one. A mutex lets several
+ * interconnect workers share the network.
+ */
+class Network {
+private:
+    /**
+     * @brief Reserved intervals of one directed link.
+     */
+    struct Link {
+        std::map<uint64_t, uint64_t> reserved;  // Start cycle -> end cycle, non-overlapping
+        uint64_t busy = 0;                      // Cycles the link was occupied
+
+        /**
+         * @brief Reserves the first free interval of a length starting at or after a cycle.
+         *
+         * @return Start cycle of the reservation.
+         */
+        uint64_t reserve(uint64_t cycle, uint64_t length);
+    };
+
+    std::unique_ptr<Topology> topology;     // nullptr: ideal network (no distance, no links)
+    uint32_t num_pes = 0;
+    uint32_t num_banks = 1;
+    std::vector<Link> links;                // Occupancy of each link
+    std::vector<uint32_t> path;             // Scratch route (guarded by mutex)
+    uint64_t traversals = 0;                // Transfers routed
+    uint64_t total_hops = 0;                // Links crossed by all transfers
+    uint64_t contention_cycles = 0;         // Cycles transfers waited for a busy link
+    mutable std::mutex mutex;
+
+public:
+    /**
+     * @brief Builds the network of a system.
+     *
+     * @param kind Topology of the network (IDEAL disables it).
+     * @param pes Number of PEs (one per router).
+     * @param banks Number of shared memory banks.
+     */
+    void configure(NetworkTopology kind, uint32_t pes, uint32_t banks);
+
+    /**
+     * @brief Checks whether messages cross a modeled network.
+     */
+    bool enabled() const { return topology != nullptr; }
+
+    /**
+     * @brief Gets the router a memory bank is attached to.
+     */
+    uint32_t bankRouter(uint32_t bank) const {
+        return static_cast<uint32_t>(static_cast<uint64_t>(bank % num_banks) * num_pes / num_banks);
+    }
+
+    /**
+     * @brief Gets the number of flits of a message carrying some payload words.
+     */
+    static uint32_t flits(size_t payload_words) {
+        return 1 + static_cast<uint32_t>((payload_words + FLIT_WORDS - 1) / FLIT_WORDS);
+    }
+
+    /**
+     * @brief Moves a transfer between two routers, reserving every link on its route.
+     *
+     * @param from Source router.
+     * @param to Destination router.
+     * @param start Cycle the head flit leaves the source.
+     * @param flits Flits of the transfer.
+     * @param hop_cycles Cycles to cross one router and link.
+     * @param flit_cycles Cycles a flit occupies a link.
+     * @return Cycle the tail flit reaches the destination.
+     */
+    uint64_t traverse(uint32_t from, uint32_t to, uint64_t start, uint32_t flits,
+                      uint64_t hop_cycles, uint64_t flit_cycles);
+
+    const Topology* getTopology() const { return topology.get(); }
+    uint64_t getTraversals() const { return traversals; }
+    uint64_t getTotalHops() const { return total_hops; }
+    uint64_t getContentionCycles() const { return contention_cycles; }
+    /**
+     * @brief Gets the cycles each link was occupied.
+     */
+    std::vector<uint64_t> getLinkBusyCycles() const;
+};
+
+#endif // TOPOLOGY_HPP
@@ -0,0 +1,134 @@
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include "tracer.hpp"
+#include "utils.hpp"
+
+Tracer tracer;
+
+namespace {
+
+const char* stageName(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::REQUEST: return "request";
+        case TraceStage::SEND: return "send";
+        case TraceStage::QUEUE: return "queue";
+        case TraceStage::SERVICE: return "service";
+        case TraceStage::RESPONSE: return "response";
+        case TraceStage::PE_WAIT: return "pe wait";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Writes the begin and end events of one async slice.
+ */
+void writeAsyncSlice(std::ofstream& out, const TraceSpan& span, const std::string& name, bool& first) {
+    uint16_t pe = static_cast<uint16_t>(span.request >> 32);
+    std::stringstream ss;
+    ss << "\"cat\":\"request\",\"id\":\"0x" << std::hex << span.request << std::dec
+       << "\",\"pid\":" << pe << ",\"tid\":0";
+    std::string common = ss.str();
+
+    out << (first ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"ph\":\"b\"," << common
+        << ",\"ts\":" << span.start;
+    if (span.stage != TraceStage::REQUEST) {
+        out << ",\"args\":{\"type\":\"" << messageTypeName(span.type) << "\"}";
+    }
+    out << "},\n{\"name\":\"" << name << "\",\"ph\":\"e\"," << common << ",\"ts\":" << span.end << "}";
+    first = false;
+}
+
+} // namespace
+
+TraceBuffer& Tracer::localBuffer() {
+    // Buffers live as long as the tracer, so the cached pointer stays valid
+    thread_local TraceBuffer* local = nullptr;
+    if (local == nullptr) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(std::make_unique<TraceBuffer>(buffer_spans));
+        local = buffers.back().get();
+    }
+    return *local;
+}
+
+void Tracer::enable(uint32_t interval, size_t spans_per_thread) {
+    sample_interval = std::max<uint32_t>(interval, 1);
+    buffer_spans = std::max<size_t>(spans_per_thread, 1);
+    active = true;
+}
+
+size_t Tracer::writeJson(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+
+    std::set<uint16_t> pes;
+    std::set<uint16_t> workers;
+    size_t written = 0;
+    bool first = true;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"time\":\"1 us = 1 simulated cycle\","
+        << "\"sample_interval\":" << sample_interval << "},\n\"traceEvents\":[";
+    for (const auto& buffer : buffers) {
+        for (const TraceSpan& span : buffer->getSpans()) {
+            uint16_t pe = static_cast<uint16_t>(span.request >> 32);
+            uint32_t req_id = static_cast<uint32_t>(span.request);
+            pes.insert(pe);
+
+            std::string name = span.stage == TraceStage::REQUEST ?
+                "PE " + std::to_string(pe) + " #" + std::to_string(req_id) : stageName(span.stage);
+            writeAsyncSlice(out, span, name, first);
+
+            if (span.stage == TraceStage::SERVICE) {
+                workers.insert(span.worker);
+                out << ",\n{\"name\":\"" << messageTypeName(span.type) << "\",\"ph\":\"X\",\"pid\":"
+                    << INTERCONNECT_ID << ",\"tid\":" << span.worker << ",\"ts\":" << span.start
+                    << ",\"dur\":" << span.end - span.start
+                    << ",\"args\":{\"pe\":" << pe << ",\"request\":" << req_id << "}}";
+            }
+            written++;
+        }
+    }
+
+    // Name the tracks
+    for (uint16_t pe : pes) {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pe
+            << ",\"args\":{\"name\":\"PE " << pe << "\"}}";
+        first = false;
+    }
+    if (!workers.empty()) {
+        out << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << INTERCONNECT_ID
+            << ",\"args\":{\"name\":\"Interconnect\"}}";
+        for (uint16_t worker : workers) {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << INTERCONNECT_ID << ",\"tid\":" << worker
+                << ",\"args\":{\"name\":\"Worker " << worker << "\"}}";
+        }
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        throw std::runtime_error("Failed to write file: " + filename);
+    }
+    return written;
+}
+
+uint64_t Tracer::getOverwritten() {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    uint64_t overwritten = 0;
+    for (const auto& buffer : buffers) {
+        overwritten += buffer->getOverwritten();
+    }
+    return overwritten;
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (auto& buffer : buffers) {
+        buffer->clear();
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "constants.hpp"
+#include "message.hpp"
+
+/**
+ * @brief Stage of a request in its trip through the system.
+ */
+enum class TraceStage : uint8_t {
+    REQUEST,            // Whole request: issue to the PE retiring the response
+    SEND,               // PE to the interconnect (network hops)
+    QUEUE,              // Waiting in the interconnect ingress queue
+    SERVICE,            // Arbitration, snoops and the memory access
+    RESPONSE,           // Interconnect back to the PE (network hops and delivery)
+    PE_WAIT             // Response waiting for the PE to pick it up
+};
+
+/**
+ * @brief One timed stage of a traced request, in simulated cycles.
+ */
+struct TraceSpan {
+    uint64_t request;           // Trace ID: (source PE << 32) | request number
+    uint64_t start;             // Cycle the stage began
+    uint64_t end;               // Cycle the stage ended
+    TraceStage stage;
+    MessageType type;           // Request type (REQUEST spans: unused)
+    uint16_t worker;            // Interconnect worker of SERVICE spans
+};
+
+/**
+ * @brief Fixed-capacity ring of the spans recorded by one thread.
+ *
+ * Only its thread writes it; once full, the oldest spans are overwritten.
+ */
+class TraceBuffer {
+private:
+    std::vector<TraceSpan> spans;   // Grows up to the capacity, then wraps
+    size_t capacity;
+    size_t next = 0;                // Oldest span once the ring is full
+    uint64_t overwritten = 0;       // Spans lost to wraparound
+
+public:
+    explicit TraceBuffer(size_t capacity_) : capacity(capacity_) {}
+
+    void push(const TraceSpan& span) {
+        if (spans.size() < capacity) {
+            spans.push_back(span);
+            return;
+        }
+        spans[next] = span;
+        next = (next + 1) % capacity;
+        overwritten++;
+    }
+
+    const std::vector<TraceSpan>& getSpans() const { return spans; }
+    uint64_t getOverwritten() const { return overwritten; }
+    void clear() { spans.clear(); next = 0; overwritten = 0; }
+};
+
+/**
+ * @brief Records request spans and exports them as Chrome trace-event JSON.
+ *
+ * Every thread appends to its own TraceBuffer, so recording takes no lock
+ * once the buffer exists. A request is sampled when its request number is a
+ * multiple of the sampling interval, so every stage of a request, recorded
+ * by the PE and by the interconnect, makes the same decision. Timestamps
+ * are simulated cycles, written as microseconds (1 cycle = 1 μs in the
+ * viewer). The buffers must only be written while no export is running.
+ */
+class Tracer {
+private:
+    bool active = false;                                // Recording enabled
+    uint32_t sample_interval = 1;                       // Trace one request in this many
+    size_t buffer_spans = TRACE_BUFFER_SPANS;           // Capacity of each thread buffer
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;  // One per recording thread
+    std::mutex buffers_mutex;                           // Guards buffers
+
+    /**
+     * @brief Gets the buffer of the calling thread, creating it on first use.
+     */
+    TraceBuffer& localBuffer();
+
+public:
+    /**
+     * @brief Starts recording.
+     *
+     * @param interval Traces one request in this many (1 traces them all).
+     * @param spans_per_thread Capacity of each thread ring buffer.
+     */
+    void enable(uint32_t interval, size_t spans_per_thread = TRACE_BUFFER_SPANS);
+
+    bool enabled() const { return active; }
+
+    /**
+     * @brief Gets the trace ID of a request.
+     */
+    static uint64_t requestId(uint16_t pe, uint32_t req_id) {
+        return (static_cast<uint64_t>(pe) << 32) | req_id;
+    }
+
+    /**
+     * @brief Checks whether a request is traced.
+     */
+    bool sampled(uint32_t req_id) const {
+        return active && req_id % sample_interval == 0;
+    }
+
+    /**
+     * @brief Records a span in the buffer of the calling thread.
+     */
+    void record(const TraceSpan& span) { localBuffer().push(span); }
+
+    /**
+     * @brief Writes every recorded span as trace-event JSON.
+     *
+     * REQUEST spans become async slices with one nested slice per stage,
+     * grouped under a process per PE; SERVICE spans are also written as
+     * complete events on one track per interconnect worker.
+     *
+     * @param filename Output file.
+     * @return Number of spans written.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    size_t writeJson(const std::string& filename);
+
+    /**
+     * @brief Gets the spans lost because a thread buffer wrapped around.
+     */
+    uint64_t getOverwritten();
+
+    /**
+     * @brief Drops every recorded span (the buffers are kept).
+     */
+    void clear();
+};
+
+extern Tracer tracer;   // Tracer of the simulator
+
+#endif // TRACER_HPP
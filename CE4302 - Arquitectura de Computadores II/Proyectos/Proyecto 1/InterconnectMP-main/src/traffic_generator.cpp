@@ -0,0 +1,106 @@
+#include <numeric>
+#include <algorithm>
+#include "traffic_generator.hpp"
+
+TrafficGenerator::TrafficGenerator(const TrafficConfig& traffic, const SystemConfig& config, uint16_t pe)
+    : traffic(traffic), pe(pe), num_pes(std::max<uint16_t>(config.num_pes, 1)),
+      cache_blocks(config.cache_blocks), block_words(config.words_per_block), memory_banks(config.memory_banks) {
+    memory_blocks = std::max<uint32_t>(static_cast<uint32_t>(config.shared_memory_size / block_words), 1);
+    bank_stride_blocks = config.memory_banks / std::gcd(config.memory_banks, block_words);
+
+    // Every PE gets its own stream, reproducible from the seed
+    std::seed_seq seq{static_cast<uint32_t>(traffic.seed), static_cast<uint32_t>(traffic.seed >> 32),
+                      static_cast<uint32_t>(pe)};
+    rng.seed(seq);
+}
+
+MessageType TrafficGenerator::nextType() {
+    uint32_t roll = randomBelow(100);
+    if (roll < traffic.read_percent) return MessageType::READ_MEM;
+    if (roll < traffic.read_percent + traffic.write_percent) return MessageType::WRITE_MEM;
+    return MessageType::BROADCAST_INVALIDATE;
+}
+
+uint32_t TrafficGenerator::nextBlock() {
+    switch (traffic.pattern) {
+        case TrafficPattern::HOTSPOT:
+            if (randomBelow(100) < TRAFFIC_HOTSPOT_PERCENT) {
+                return randomBelow(std::min(TRAFFIC_HOTSPOT_BLOCKS, memory_blocks));
+            }
+            return randomBelow(memory_blocks);
+        case TrafficPattern::STRIDED: {
+            uint64_t base = static_cast<uint64_t>(pe) * memory_blocks / num_pes;
+            return static_cast<uint32_t>((base + issued * traffic.stride_blocks) % memory_blocks);
+        }
+        case TrafficPattern::PRODUCER_CONSUMER: {
+            // Both PEs of a pair walk the same buffer in the same order
+            uint64_t base = static_cast<uint64_t>(pe / 2) * TRAFFIC_BUFFER_BLOCKS;
+            return static_cast<uint32_t>((base + issued % TRAFFIC_BUFFER_BLOCKS) % memory_blocks);
+        }
+        case TrafficPattern::MIGRATORY:
+            return randomBelow(std::min(TRAFFIC_MIGRATORY_BLOCKS, memory_blocks));
+        case TrafficPattern::ALL_TO_ONE: {
+            // Word addresses that are multiples of the bank count all live in bank 0
+            uint32_t candidates = (memory_blocks + bank_stride_blocks - 1) / bank_stride_blocks;
+            return randomBelow(candidates) * bank_stride_blocks;
+        }
+        case TrafficPattern::UNIFORM:
+        default:
+            return randomBelow(memory_blocks);
+    }
+}
+
+InstructionRecord TrafficGenerator::next() {
+    MessageType type;
+    uint32_t block;
+    if (migratory_write) {
+        // Second half of a migratory read-modify-write
+        type = MessageType::WRITE_MEM;
+        block = migratory_block;
+        migratory_write = false;
+    } else {
+        type = nextType();
+        if (type != MessageType::BROADCAST_INVALIDATE) {
+            if (traffic.pattern == TrafficPattern::PRODUCER_CONSUMER) {
+                type = pe % 2 == 0 ? MessageType::WRITE_MEM : MessageType::READ_MEM;
+            } else if (traffic.pattern == TrafficPattern::MIGRATORY) {
+                type = MessageType::READ_MEM;
+            }
+        }
+        block = nextBlock();
+        if (traffic.pattern == TrafficPattern::MIGRATORY && type == MessageType::READ_MEM) {
+            migratory_block = block;
+            migratory_write = true;
+        }
+    }
+    issued++;
+
+    InstructionRecord record{};
+    record.type = static_cast<uint8_t>(type);
+    switch (type) {
+        case MessageType::READ_MEM:
+            record.addr = block * block_words * 4;
+            record.operand = block_words;
+            break;
+        case MessageType::WRITE_MEM:
+            // Stores scratchpad block 0, where READ_MEM responses land, so that
+            // invalidations of other blocks do not discard the write
+            record.addr = block * block_words * 4;
+            record.operand = 0;
+            record.count = 1;
+            break;
+        default:
+            // Block 0 is left alone; invalidations are routed by cache line,
+            // and bank 0 owns the lines that are multiples of the bank count
+            if (cache_blocks == 1) {
+                record.operand = 0;
+            } else if (traffic.pattern == TrafficPattern::ALL_TO_ONE) {
+                uint32_t lines = (cache_blocks - 1) / memory_banks;
+                record.operand = lines == 0 ? 0 : (1 + randomBelow(lines)) * memory_banks;
+            } else {
+                record.operand = 1 + block % (cache_blocks - 1);
+            }
+            break;
+    }
+    return record;
+}
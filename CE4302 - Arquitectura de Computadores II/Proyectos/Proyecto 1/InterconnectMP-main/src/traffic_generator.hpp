@@ -0,0 +1,95 @@
+#ifndef TRAFFIC_GENERATOR_HPP
+#define TRAFFIC_GENERATOR_HPP
+
+#include <random>
+#include <string>
+#include <cstdint>
+#include "constants.hpp"
+#include "system_config.hpp"
+#include "instruction_memory.hpp"
+
+/**
+ * @brief Address pattern of the synthetic traffic.
+ */
+enum class TrafficPattern {
+    UNIFORM,            // Any block of the shared memory
+    HOTSPOT,            // TRAFFIC_HOTSPOT_PERCENT of the accesses to a few hot blocks
+    STRIDED,            // Each PE streams through its own slice of memory
+    PRODUCER_CONSUMER,  // Even PEs write a buffer that the next odd PE reads
+    MIGRATORY,          // Read-then-write of a few blocks shared by every PE
+    ALL_TO_ONE          // Every access goes to memory bank 0
+};
+
+inline const char* trafficPatternName(TrafficPattern pattern) {
+    switch (pattern) {
+        case TrafficPattern::UNIFORM: return "uniform";
+        case TrafficPattern::HOTSPOT: return "hotspot";
+        case TrafficPattern::STRIDED: return "strided";
+        case TrafficPattern::PRODUCER_CONSUMER: return "prodcons";
+        case TrafficPattern::MIGRATORY: return "migratory";
+        case TrafficPattern::ALL_TO_ONE: return "alltoone";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Parameters of the synthetic traffic of every PE.
+ */
+struct TrafficConfig {
+    TrafficPattern pattern = TrafficPattern::UNIFORM;
+    uint64_t length = DEFAULT_TRAFFIC_LENGTH;       // Instructions per PE
+    uint64_t seed = 1;
+    uint32_t read_percent = 60;                     // Instruction mix (adds up to 100); prodcons and migratory
+                                                    // keep only its invalidation share
+    uint32_t write_percent = 30;
+    uint32_t invalidate_percent = 10;
+    uint32_t stride_blocks = 1;                     // Blocks between consecutive STRIDED accesses
+};
+
+/**
+ * @brief Produces the instruction stream of one PE from a seed.
+ *
+ * Instructions are generated one at a time as the PE consumes them, so
+ * streams of millions of operations take no memory. Every instruction
+ * moves one cache block (words_per_block words) at a block-aligned address
+ * inside the shared memory, so generated instructions pass the PE range
+ * checks. The stream depends only on the configuration, the seed and the
+ * PE ID.
+ */
+class TrafficGenerator {
+private:
+    TrafficConfig traffic;
+    uint16_t pe;
+    uint16_t num_pes;
+    uint32_t cache_blocks;
+    uint32_t block_words;
+    uint32_t memory_banks;
+    uint32_t memory_blocks;                 // Shared memory blocks an instruction may start at
+    uint32_t bank_stride_blocks;            // Blocks between consecutive addresses of bank 0
+    std::mt19937_64 rng;
+    uint64_t issued = 0;                    // Instructions generated so far
+    uint32_t migratory_block = 0;           // Block written after the current migratory read
+    bool migratory_write = false;
+
+    uint32_t randomBelow(uint32_t bound) { return static_cast<uint32_t>(rng() % bound); }
+
+    /**
+     * @brief Picks the shared memory block of the next access.
+     */
+    uint32_t nextBlock();
+
+    /**
+     * @brief Picks the instruction type from the configured mix.
+     */
+    MessageType nextType();
+
+public:
+    TrafficGenerator(const TrafficConfig& traffic, const SystemConfig& config, uint16_t pe);
+
+    /**
+     * @brief Generates the next instruction.
+     */
+    InstructionRecord next();
+};
+
+#endif // TRAFFIC_GENERATOR_HPP
@@ -52,28 +52,37 @@ void printMessage(const Message& msg) {
     }
 }
 
+const char* messageTypeName(MessageType type) {
+    switch (type) {
+        case MessageType::READ_MEM: return "READ_MEM";
+        case MessageType::WRITE_MEM: return "WRITE_MEM";
+        case MessageType::BROADCAST_INVALIDATE: return "BROADCAST_INVALIDATE";
+        case MessageType::READ_RESP: return "READ_RESP";
+        case MessageType::WRITE_RESP: return "WRITE_RESP";
+        case MessageType::INV_COMPLETE: return "INV_COMPLETE";
+        case MessageType::READ_SHARED: return "READ_SHARED";
+        case MessageType::READ_EXCLUSIVE: return "READ_EXCLUSIVE";
+        case MessageType::UPGRADE: return "UPGRADE";
+        case MessageType::WRITEBACK: return "WRITEBACK";
+        default: return "UNKNOWN";
+    }
+}
+
 std::string messageToLog(const std::string& begin, const Message& msg) {
     std::stringstream ss;
-    ss << "\n\ttype: ";
-    
-    switch(msg.type) {
-        case MessageType::READ_MEM: ss << "READ_MEM"; break;
-        case MessageType::WRITE_MEM: ss << "WRITE_MEM"; break;
-        case MessageType::BROADCAST_INVALIDATE: ss << "BROADCAST_INVALIDATE"; break;
-        case MessageType::READ_RESP: ss << "READ_RESP"; break;
-        case MessageType::WRITE_RESP: ss << "WRITE_RESP"; break;
-        case MessageType::INV_COMPLETE: ss << "INV_COMPLETE"; break;
-        default: ss << "UNKNOWN"; break;
-    }
+    ss << "\n\ttype: " << messageTypeName(msg.type);
     
     ss << " | src: 0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << static_cast<int>(msg.src) << std::dec
        << " | dest: 0x" << std::hex << std::uppercase << std::setw(2) << static_cast<int>(msg.dest) << std::dec;
 
-    if (msg.type == MessageType::WRITE_MEM || msg.type == MessageType::READ_MEM) {
+    bool coherent = msg.type == MessageType::READ_SHARED || msg.type == MessageType::READ_EXCLUSIVE ||
+                    msg.type == MessageType::UPGRADE || msg.type == MessageType::WRITEBACK;
+    if (msg.type == MessageType::WRITE_MEM || msg.type == MessageType::READ_MEM || coherent) {
         ss << " | addr: 0x" << std::hex << std::uppercase << std::setw(4) << msg.addr << std::dec;
     }
 
-    if (msg.type == MessageType::READ_MEM) {
+    if (msg.type == MessageType::READ_MEM || msg.type == MessageType::READ_SHARED ||
+        msg.type == MessageType::READ_EXCLUSIVE) {
         ss << " | size: 0x" << std::hex << std::uppercase << std::setw(4) << msg.size << std::dec;
     }
 
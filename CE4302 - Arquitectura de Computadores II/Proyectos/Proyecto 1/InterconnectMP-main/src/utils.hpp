@@ -13,6 +13,11 @@
  */
 void printMessage(const Message& msg);
 
+/**
+ * @brief Gets the name of a message type as written in the logs.
+ */
+const char* messageTypeName(MessageType type);
+
 /**
  * @brief Return the incoming/outgoing message
  *